@@ -0,0 +1,209 @@
+#include "ActuationLatencyMonitor.hpp"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+using namespace base;
+using namespace deep_trekker;
+
+void LatencyHistogram::add(Time const& latency)
+{
+    if (count == 0 || latency < min) {
+        min = latency;
+    }
+    if (count == 0 || latency > max) {
+        max = latency;
+    }
+    ++count;
+    sum = sum + latency;
+    last = latency;
+
+    uint64_t bin = latency.toMicroseconds() / bin_width.toMicroseconds();
+    if (bin < bins.size()) {
+        ++bins[bin];
+    }
+    else {
+        ++overflow;
+    }
+}
+
+Time LatencyHistogram::mean() const
+{
+    if (count == 0) {
+        return Time();
+    }
+    return Time::fromMicroseconds(sum.toMicroseconds() / count);
+}
+
+Time LatencyHistogram::quantile(double q) const
+{
+    if (count == 0) {
+        return Time();
+    }
+
+    uint64_t target = std::max<uint64_t>(1, ceil(q * count));
+    uint64_t cumulated = 0;
+    for (size_t i = 0; i < bins.size(); ++i) {
+        cumulated += bins[i];
+        if (cumulated >= target) {
+            return bin_width * static_cast<double>(i + 1);
+        }
+    }
+    return max;
+}
+
+/** The percentage the DT API uses for a command value */
+static double toPercent(double value, double min_value)
+{
+    return round(min(max(value, min_value), 1.0) * 100);
+}
+
+ActuationLatencyMonitor::ActuationLatencyMonitor(Time const& bin_width,
+    size_t bin_count,
+    Time const& timeout)
+    : m_timeout(timeout)
+{
+    for (auto& histogram : m_histograms) {
+        histogram.bin_width = bin_width;
+        histogram.bins.resize(bin_count, 0);
+    }
+}
+
+void ActuationLatencyMonitor::commandSentDrive(
+    commands::LinearAngular6DCommand const& command,
+    Time const& time)
+{
+    commandSent(ACTUATOR_DRIVE,
+        {toPercent(command.linear.x(), -1),
+            toPercent(command.linear.y(), -1),
+            toPercent(command.linear.z(), -1),
+            toPercent(command.angular.z(), -1)},
+        time);
+}
+
+void ActuationLatencyMonitor::commandSentCameraHeadLight(double intensity,
+    Time const& time)
+{
+    commandSent(ACTUATOR_CAMERA_HEAD_LIGHT, {toPercent(intensity, 0), 0, 0, 0}, time);
+}
+
+void ActuationLatencyMonitor::commandSentCameraHeadTilt(double speed, Time const& time)
+{
+    double moving = toPercent(speed, -1) != 0;
+    commandSent(ACTUATOR_CAMERA_HEAD_TILT, {moving, 0, 0, 0}, time);
+}
+
+void ActuationLatencyMonitor::commandSentAuxLight(double intensity, Time const& time)
+{
+    commandSent(ACTUATOR_AUX_LIGHT, {toPercent(intensity, 0), 0, 0, 0}, time);
+}
+
+void ActuationLatencyMonitor::commandSent(Actuator actuator,
+    array<double, 4> const& expected,
+    Time const& time)
+{
+    auto& measurement = m_measurements[actuator];
+    if (measurement.valid && measurement.expected == expected) {
+        return;
+    }
+
+    if (measurement.measuring) {
+        ++m_histograms[actuator].replaced;
+    }
+    measurement.expected = expected;
+    measurement.send_time = time;
+    measurement.measuring = true;
+    measurement.valid = true;
+}
+
+void ActuationLatencyMonitor::update(DeviceSnapshot const& snapshot)
+{
+    auto const& revolution = snapshot.revolution;
+    if (snapshot.has(FIELD_GROUP_DRIVE_THRUST)) {
+        // See CommandAndStateMessageParser::decodeDriveStates for the
+        // mapping between the thrust fields and the setpoint
+        auto const& setpoint = revolution.drive_setpoint;
+        Eigen::Quaterniond reported_yaw = setpoint.orientation;
+        array<double, 4> reported = {round(setpoint.position.x()),
+            round(setpoint.position.y()),
+            round(setpoint.position.z()),
+            m_measurements[ACTUATOR_DRIVE].expected[3]};
+        // The yaw thrust is stored as an angle, compare it in quaternion form
+        Eigen::Quaterniond expected_yaw(
+            Eigen::AngleAxisd(reported[3], Eigen::Vector3d::UnitZ()));
+        if (reported_yaw.angularDistance(expected_yaw) > 1e-3) {
+            reported[3] = NAN;
+        }
+        match(ACTUATOR_DRIVE, reported, snapshot.time);
+    }
+    if (snapshot.has(FIELD_GROUP_CAMERA_HEAD)) {
+        match(ACTUATOR_CAMERA_HEAD_LIGHT,
+            {round(revolution.camera_head.light * 100), 0, 0, 0},
+            snapshot.time);
+
+        auto const& tilt_motor = revolution.camera_head.motor_states.elements;
+        if (!tilt_motor.empty()) {
+            double moving = tilt_motor[0].raw != 0;
+            match(ACTUATOR_CAMERA_HEAD_TILT, {moving, 0, 0, 0}, snapshot.time);
+        }
+    }
+    if (snapshot.has(FIELD_GROUP_AUX_LIGHT)) {
+        match(ACTUATOR_AUX_LIGHT,
+            {round(revolution.aux_light * 100), 0, 0, 0},
+            snapshot.time);
+    }
+    expire(snapshot.time);
+}
+
+void ActuationLatencyMonitor::expire(Time const& now)
+{
+    for (size_t i = 0; i < ACTUATOR_COUNT; ++i) {
+        auto& measurement = m_measurements[i];
+        if (measurement.measuring && now - measurement.send_time > m_timeout) {
+            ++m_histograms[i].timeouts;
+            measurement.measuring = false;
+        }
+    }
+}
+
+void ActuationLatencyMonitor::match(Actuator actuator,
+    array<double, 4> const& reported,
+    Time const& time)
+{
+    auto& measurement = m_measurements[actuator];
+    if (!measurement.measuring) {
+        return;
+    }
+
+    if (measurement.expected == reported) {
+        m_histograms[actuator].add(time - measurement.send_time);
+        measurement.measuring = false;
+    }
+}
+
+LatencyHistogram const& ActuationLatencyMonitor::getHistogram(Actuator actuator) const
+{
+    return m_histograms.at(actuator);
+}
+
+bool ActuationLatencyMonitor::isMeasuring(Actuator actuator) const
+{
+    return m_measurements.at(actuator).measuring;
+}
+
+void ActuationLatencyMonitor::reset()
+{
+    for (size_t i = 0; i < ACTUATOR_COUNT; ++i) {
+        m_measurements[i] = Measurement();
+        auto& histogram = m_histograms[i];
+        fill(histogram.bins.begin(), histogram.bins.end(), 0);
+        histogram.overflow = 0;
+        histogram.timeouts = 0;
+        histogram.replaced = 0;
+        histogram.count = 0;
+        histogram.min = Time();
+        histogram.max = Time();
+        histogram.sum = Time();
+        histogram.last = Time();
+    }
+}
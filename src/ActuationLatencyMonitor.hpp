@@ -0,0 +1,121 @@
+#ifndef _DEEP_TREKKER_ACTUATION_LATENCY_MONITOR_HPP_
+#define _DEEP_TREKKER_ACTUATION_LATENCY_MONITOR_HPP_
+
+#include "base/Time.hpp"
+#include "base/commands/LinearAngular6DCommand.hpp"
+#include "deep_trekker/DeviceSnapshot.hpp"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace deep_trekker {
+    /** Histogram of latencies with fixed-width bins */
+    struct LatencyHistogram {
+        base::Time bin_width;
+        /** bins[i] counts the latencies in [i * bin_width, (i + 1) * bin_width) */
+        std::vector<uint64_t> bins;
+        /** Latencies beyond the last bin */
+        uint64_t overflow = 0;
+        /** Commands whose state was never reported within the timeout */
+        uint64_t timeouts = 0;
+        /** Commands replaced by a different one before their state was reported */
+        uint64_t replaced = 0;
+
+        uint64_t count = 0;
+        base::Time min;
+        base::Time max;
+        base::Time sum;
+        base::Time last;
+
+        void add(base::Time const& latency);
+        base::Time mean() const;
+        /** Upper bound of the bin holding the given quantile, in [0, 1]
+         *
+         * Returns a null time if there are no samples, and max if the quantile
+         * falls in the overflow
+         */
+        base::Time quantile(double q) const;
+    };
+
+    /** Measures the time between sending a command and the vehicle reporting it
+     *
+     * Each command passed to a commandSent* method is tagged with its send
+     * time. The latency is the time between this send time and the receive time
+     * of the first snapshot passed to update() whose echoed state matches the
+     * command. Commands equal to the one being measured do not restart the
+     * measurement, and a new command replaces the one being measured.
+     *
+     * The vehicle does not echo the tilt speed, only the tilt position. The tilt
+     * latency is measured on the tilt motor instead: a zero speed matches a
+     * zero motor PWM, and a non-zero speed a non-zero PWM.
+     */
+    class ActuationLatencyMonitor {
+    public:
+        enum Actuator {
+            ACTUATOR_DRIVE,
+            ACTUATOR_CAMERA_HEAD_LIGHT,
+            ACTUATOR_CAMERA_HEAD_TILT,
+            ACTUATOR_AUX_LIGHT,
+            ACTUATOR_COUNT
+        };
+
+        /**
+         * @param bin_width width of the histogram bins
+         * @param bin_count number of histogram bins
+         * @param timeout time after which a command that was not reported is
+         *   counted as a timeout
+         */
+        ActuationLatencyMonitor(
+            base::Time const& bin_width = base::Time::fromMilliseconds(10),
+            size_t bin_count = 100,
+            base::Time const& timeout = base::Time::fromSeconds(5));
+
+        void commandSentDrive(base::commands::LinearAngular6DCommand const& command,
+            base::Time const& time);
+        void commandSentCameraHeadLight(double intensity, base::Time const& time);
+        void commandSentCameraHeadTilt(double speed, base::Time const& time);
+        void commandSentAuxLight(double intensity, base::Time const& time);
+
+        /** Match the states of a snapshot against the commands being measured
+         *
+         * The snapshot's time is used as the state reception time. It then
+         * calls expire with this time.
+         */
+        void update(DeviceSnapshot const& snapshot);
+
+        /** Count the commands not reported within the timeout as timeouts
+         *
+         * update() calls it already. Call it periodically as well if the vehicle
+         * may stop reporting the states of an actuator altogether.
+         */
+        void expire(base::Time const& now);
+
+        LatencyHistogram const& getHistogram(Actuator actuator) const;
+        /** Whether a command of this actuator is waiting to be reported */
+        bool isMeasuring(Actuator actuator) const;
+        /** Clear the histograms and the commands being measured */
+        void reset();
+
+    private:
+        struct Measurement {
+            /** Commanded values, in the units of the DT API */
+            std::array<double, 4> expected{};
+            base::Time send_time;
+            bool measuring = false;
+            bool valid = false;
+        };
+
+        base::Time m_timeout;
+        std::array<Measurement, ACTUATOR_COUNT> m_measurements;
+        std::array<LatencyHistogram, ACTUATOR_COUNT> m_histograms;
+
+        void commandSent(Actuator actuator,
+            std::array<double, 4> const& expected,
+            base::Time const& time);
+        void match(Actuator actuator,
+            std::array<double, 4> const& reported,
+            base::Time const& time);
+    };
+}
+
+#endif
@@ -0,0 +1,137 @@
+#ifndef _DEEP_TREKKER_BOUNDED_QUEUE_HPP_
+#define _DEEP_TREKKER_BOUNDED_QUEUE_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+
+namespace deep_trekker {
+    /** Fixed-capacity lock-free ring buffer
+     *
+     * Each slot carries a sequence number that tells whether it is ready to be
+     * written or read, which makes tryPush and tryPop safe to call concurrently
+     * from any number of threads. It is used as a single-producer
+     * single-consumer queue, the producer popping only to drop the oldest
+     * element when the queue is full.
+     *
+     * The elements are moved in and out, and the slots are allocated once at
+     * construction.
+     */
+    template <typename T> class BoundedQueue {
+    public:
+        /** @param capacity the queue capacity, rounded up to a power of two.
+         *   The sequence numbers need at least two slots, so a capacity of 1
+         *   is rounded up to 2
+         */
+        explicit BoundedQueue(size_t capacity)
+        {
+            if (capacity == 0) {
+                throw std::invalid_argument("BoundedQueue capacity must be positive");
+            }
+            size_t rounded = 2;
+            while (rounded < capacity) {
+                rounded <<= 1;
+            }
+            m_slots.reset(new Slot[rounded]);
+            for (size_t i = 0; i < rounded; ++i) {
+                m_slots[i].sequence.store(i, std::memory_order_relaxed);
+            }
+            m_mask = rounded - 1;
+        }
+
+        size_t capacity() const
+        {
+            return m_mask + 1;
+        }
+
+        /** The number of elements in the queue
+         *
+         * It is exact only when no push or pop is in progress
+         */
+        size_t size() const
+        {
+            size_t pushed = m_push_position.load(std::memory_order_acquire);
+            size_t popped = m_pop_position.load(std::memory_order_acquire);
+            return pushed > popped ? pushed - popped : 0;
+        }
+
+        bool empty() const
+        {
+            return size() == 0;
+        }
+
+        /** Move \c value in the queue
+         *
+         * @return false if the queue is full, in which case \c value is left
+         *   untouched
+         */
+        bool tryPush(T& value)
+        {
+            size_t position = m_push_position.load(std::memory_order_relaxed);
+            while (true) {
+                Slot& slot = m_slots[position & m_mask];
+                size_t sequence = slot.sequence.load(std::memory_order_acquire);
+                auto diff = static_cast<std::ptrdiff_t>(sequence - position);
+                if (diff == 0) {
+                    if (m_push_position.compare_exchange_weak(position,
+                            position + 1,
+                            std::memory_order_relaxed)) {
+                        slot.value = std::move(value);
+                        slot.sequence.store(position + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (diff < 0) {
+                    return false;
+                }
+                else {
+                    position = m_push_position.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        /** Move the oldest element out of the queue into \c value
+         *
+         * @return false if the queue is empty
+         */
+        bool tryPop(T& value)
+        {
+            size_t position = m_pop_position.load(std::memory_order_relaxed);
+            while (true) {
+                Slot& slot = m_slots[position & m_mask];
+                size_t sequence = slot.sequence.load(std::memory_order_acquire);
+                auto diff = static_cast<std::ptrdiff_t>(sequence - (position + 1));
+                if (diff == 0) {
+                    if (m_pop_position.compare_exchange_weak(position,
+                            position + 1,
+                            std::memory_order_relaxed)) {
+                        value = std::move(slot.value);
+                        slot.sequence.store(position + m_mask + 1,
+                            std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (diff < 0) {
+                    return false;
+                }
+                else {
+                    position = m_pop_position.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+    private:
+        struct Slot {
+            std::atomic<size_t> sequence;
+            T value;
+        };
+
+        std::unique_ptr<Slot[]> m_slots;
+        size_t m_mask = 0;
+        alignas(64) std::atomic<size_t> m_push_position{0};
+        alignas(64) std::atomic<size_t> m_pop_position{0};
+    };
+}
+
+#endif
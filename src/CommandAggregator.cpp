@@ -0,0 +1,140 @@
+#include "CommandAggregator.hpp"
+#include "CommandAndStateMessageParser.hpp"
+
+using namespace std;
+using namespace base;
+using namespace deep_trekker;
+
+CommandAggregator::CommandAggregator(string const& api_version, Time const& flush_period)
+    : m_api_version(api_version)
+    , m_flush_period(flush_period)
+{
+}
+
+void CommandAggregator::setFlushPeriod(Time const& period)
+{
+    m_flush_period = period;
+}
+
+Time CommandAggregator::getFlushPeriod() const
+{
+    return m_flush_period;
+}
+
+Json::Value& CommandAggregator::device(string const& address, int model)
+{
+    auto& device = m_pending[address];
+    device["model"] = model;
+    return device;
+}
+
+void CommandAggregator::setDriveModes(string const& address,
+    int model,
+    DriveMode const& command)
+{
+    CommandAndStateMessageParser::writeDriveModes(device(address, model), command);
+}
+
+void CommandAggregator::setAutoStabilization(string const& address,
+    int model,
+    bool auto_stabilization)
+{
+    CommandAndStateMessageParser::writeAutoStabilization(device(address, model),
+        auto_stabilization);
+}
+
+void CommandAggregator::setMotorsDisabled(string const& address,
+    int model,
+    bool motors_disabled)
+{
+    CommandAndStateMessageParser::writeMotorsDisabled(device(address, model),
+        motors_disabled);
+}
+
+void CommandAggregator::setDrive(string const& address,
+    int model,
+    commands::LinearAngular6DCommand const& command)
+{
+    CommandAndStateMessageParser::writeDrive(device(address, model), command);
+}
+
+void CommandAggregator::setPoweredReel(string const& address,
+    int model,
+    samples::Joints const& command)
+{
+    CommandAndStateMessageParser::writePoweredReel(device(address, model), command);
+}
+
+void CommandAggregator::setGrabber(string const& address, samples::Joints const& command)
+{
+    // The grabber command does not carry the device model
+    CommandAndStateMessageParser::writeGrabber(m_pending[address], command);
+}
+
+void CommandAggregator::setCameraHeadTilt(string const& address,
+    int model,
+    int camera_head_model,
+    samples::Joints const& tilt)
+{
+    CommandAndStateMessageParser::writeCameraHeadTilt(device(address, model),
+        camera_head_model,
+        tilt);
+}
+
+void CommandAggregator::setCameraHeadLaser(string const& address,
+    int model,
+    int camera_head_model,
+    bool enabled)
+{
+    CommandAndStateMessageParser::writeCameraHeadLaser(device(address, model),
+        camera_head_model,
+        enabled);
+}
+
+void CommandAggregator::setCameraHeadLight(string const& address,
+    int model,
+    int camera_head_model,
+    double intensity)
+{
+    CommandAndStateMessageParser::writeCameraHeadLight(device(address, model),
+        camera_head_model,
+        intensity);
+}
+
+void CommandAggregator::setAuxLight(string const& address, int model, double intensity)
+{
+    CommandAndStateMessageParser::writeAuxLight(device(address, model), intensity);
+}
+
+bool CommandAggregator::hasPendingCommands() const
+{
+    return !m_pending.empty();
+}
+
+vector<string> CommandAggregator::flush()
+{
+    vector<string> messages;
+    Json::FastWriter fast;
+    for (auto& entry : m_pending) {
+        Json::Value message;
+        message["apiVersion"] = m_api_version;
+        message["method"] = "SET";
+        message["payload"]["devices"][entry.first].swap(entry.second);
+        messages.push_back(fast.write(message));
+    }
+    m_pending.clear();
+    return messages;
+}
+
+vector<string> CommandAggregator::flushIfDue(Time const& now)
+{
+    if (!m_last_flush.isNull() && now - m_last_flush < m_flush_period) {
+        return vector<string>();
+    }
+
+    auto messages = flush();
+    if (!messages.empty()) {
+        m_last_flush = now;
+    }
+    return messages;
+}
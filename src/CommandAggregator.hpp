@@ -0,0 +1,94 @@
+#ifndef _DEEP_TREKKER_COMMAND_AGGREGATOR_HPP_
+#define _DEEP_TREKKER_COMMAND_AGGREGATOR_HPP_
+
+#include "base/Time.hpp"
+#include "base/commands/LinearAngular6DCommand.hpp"
+#include "deep_trekker/DeepTrekkerCommands.hpp"
+#include "deep_trekker/DeepTrekkerStates.hpp"
+#include <json/json.h>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace deep_trekker {
+    /** Accumulates the actuator commands of a control tick, and combines them into
+     * one SET message per device
+     *
+     * Each set* method replaces the previous setpoint of the same actuator. The
+     * device entry of the combined message has the same structure than the one of
+     * the matching CommandAndStateMessageParser::parse*Message methods, as it is
+     * written by the same CommandAndStateMessageParser::write* methods.
+     */
+    class CommandAggregator {
+    public:
+        /**
+         * @param flush_period minimum time between two flushes done by flushIfDue.
+         *   Zero means that flushIfDue flushes on every call.
+         */
+        explicit CommandAggregator(std::string const& api_version,
+            base::Time const& flush_period = base::Time());
+
+        void setFlushPeriod(base::Time const& period);
+        base::Time getFlushPeriod() const;
+
+        void setDriveModes(std::string const& address,
+            int model,
+            DriveMode const& command);
+        void setAutoStabilization(std::string const& address,
+            int model,
+            bool auto_stabilization);
+        void setMotorsDisabled(std::string const& address,
+            int model,
+            bool motors_disabled);
+        void setDrive(std::string const& address,
+            int model,
+            base::commands::LinearAngular6DCommand const& command);
+        void setPoweredReel(std::string const& address,
+            int model,
+            base::samples::Joints const& command);
+        void setGrabber(std::string const& address, base::samples::Joints const& command);
+        void setCameraHeadTilt(std::string const& address,
+            int model,
+            int camera_head_model,
+            base::samples::Joints const& tilt);
+        void setCameraHeadLaser(std::string const& address,
+            int model,
+            int camera_head_model,
+            bool enabled);
+        void setCameraHeadLight(std::string const& address,
+            int model,
+            int camera_head_model,
+            double intensity);
+        void setAuxLight(std::string const& address, int model, double intensity);
+
+        /** Whether some commands have been set since the last flush */
+        bool hasPendingCommands() const;
+
+        /** Return one SET message per device that has pending commands, and
+         * clear them
+         */
+        std::vector<std::string> flush();
+
+        /** Flush if at least the flush period elapsed since the last flush
+         *
+         * Only the flushes that returned messages count, so that a command set
+         * after an idle period is sent right away
+         *
+         * @return the flushed messages, empty if it was not time to flush or if
+         *   there were no pending commands
+         */
+        std::vector<std::string> flushIfDue(base::Time const& now);
+
+    private:
+        std::string m_api_version;
+        base::Time m_flush_period;
+        base::Time m_last_flush;
+
+        /** payload/devices entry of the pending commands, per device */
+        std::map<std::string, Json::Value> m_pending;
+
+        Json::Value& device(std::string const& address, int model);
+    };
+}
+
+#endif
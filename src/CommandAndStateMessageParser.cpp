@@ -1,4 +1,5 @@
 #include "CommandAndStateMessageParser.hpp"
+#include <algorithm>
 #include <iostream>
 
 using namespace std;
@@ -12,9 +13,228 @@ CommandAndStateMessageParser::CommandAndStateMessageParser()
 {
 }
 
+void CommandAndStateMessageParser::setDecodeMode(DecodeMode mode)
+{
+    m_decode_mode = mode;
+}
+
+CommandAndStateMessageParser::DecodeMode CommandAndStateMessageParser::getDecodeMode()
+    const
+{
+    return m_decode_mode;
+}
+
 bool CommandAndStateMessageParser::parseJSONMessage(char const* data, string& errors)
 {
-    return mReader->parse(data, data + strlen(data), &m_json_data, &errors);
+    return parseJSONMessage(data, strlen(data), errors);
+}
+
+bool CommandAndStateMessageParser::parseJSONMessage(string_view data, string& errors)
+{
+    return parseJSONMessage(data.data(), data.size(), errors);
+}
+
+bool CommandAndStateMessageParser::parseJSONMessage(char const* data,
+    size_t length,
+    string& errors)
+{
+    return parseJSONMessage(data, length, Time::now(), errors);
+}
+
+bool CommandAndStateMessageParser::parseJSONMessage(string_view data,
+    Time const& receive_time,
+    string& errors)
+{
+    return parseJSONMessage(data.data(), data.size(), receive_time, errors);
+}
+
+bool CommandAndStateMessageParser::parseJSONMessage(char const* data,
+    size_t length,
+    Time const& receive_time,
+    string& errors)
+{
+    m_receive_time = receive_time;
+    m_empty_snapshot.time = receive_time;
+
+    bool result;
+    if (m_decode_mode == DECODE_STREAMING) {
+        result = parseStreaming(data, data + length, errors);
+        m_method = m_streaming_decoder.getMethod();
+    }
+    else {
+        result = mReader->parse(data, data + length, &m_json_data, &errors);
+        indexJsonDevices();
+        auto const& method = getField(m_json_data, "method");
+        m_method = method.isString() ? method.asString() : string();
+    }
+
+    if (m_state_merging) {
+        mergeParsedStates(result);
+    }
+    m_parse_time = Time::now();
+    return result;
+}
+
+Time CommandAndStateMessageParser::getReceiveTime() const
+{
+    return m_receive_time;
+}
+
+string const& CommandAndStateMessageParser::getMethod() const
+{
+    return m_method;
+}
+
+Time CommandAndStateMessageParser::getDecodeLatency() const
+{
+    return m_parse_time - m_receive_time;
+}
+
+bool CommandAndStateMessageParser::parseJSONRecords(string_view buffer,
+    char separator,
+    OnRecord const& on_record,
+    string& errors)
+{
+    bool result = true;
+    size_t record_index = 0;
+    auto receive_time = Time::now();
+    while (!buffer.empty()) {
+        size_t record_end = buffer.find(separator);
+        string_view record = buffer.substr(0, record_end);
+        buffer.remove_prefix(
+            record_end == string_view::npos ? buffer.size() : record_end + 1);
+
+        if (record.find_first_not_of(" \t\r\n") == string_view::npos) {
+            continue;
+        }
+
+        string record_errors;
+        if (parseJSONMessage(record, receive_time, record_errors)) {
+            on_record(record);
+        }
+        else {
+            errors += "record " + to_string(record_index) + ": " + record_errors;
+            result = false;
+        }
+        record_index++;
+    }
+    return result;
+}
+
+bool CommandAndStateMessageParser::parseStreaming(char const* begin,
+    char const* end,
+    string& errors)
+{
+    m_json_data = Json::Value();
+    for (auto& device : m_devices) {
+        device.in_message = false;
+        device.json = nullptr;
+        device.raw.present.reset();
+    }
+
+    auto resolve = [this](string_view address) {
+        auto& device = m_devices[registerDevice(address).index];
+        device.in_message = true;
+        return &device.raw;
+    };
+    bool result = m_streaming_decoder.decode(begin, end, resolve, errors);
+
+    for (auto& device : m_devices) {
+        if (device.in_message) {
+            StreamingStateDecoder::toSnapshot(device.raw,
+                m_receive_time,
+                device.snapshot);
+            device.model = device.snapshot.model;
+            device.decoded = true;
+        }
+    }
+    return result;
+}
+
+void CommandAndStateMessageParser::indexJsonDevices()
+{
+    for (auto& device : m_devices) {
+        device.in_message = false;
+        device.decoded = false;
+        device.json = nullptr;
+    }
+
+    auto const& devices = getField(getField(m_json_data, "payload"), "devices");
+    if (!devices.isObject()) {
+        return;
+    }
+    for (auto it = devices.begin(); it != devices.end(); ++it) {
+        char const* end = nullptr;
+        char const* begin = it.memberName(&end);
+        auto& device = m_devices[registerDevice(string_view(begin, end - begin)).index];
+        device.in_message = true;
+        device.json = &*it;
+
+        auto const& model = getField(*it, "model");
+        device.model = model.isIntegral() ? model.asInt() : DEVICE_MODEL_UNKNOWN;
+    }
+}
+
+CommandAndStateMessageParser::DeviceHandle CommandAndStateMessageParser::registerDevice(
+    string_view address)
+{
+    auto it = m_device_index.find(address);
+    if (it != m_device_index.end()) {
+        return DeviceHandle{it->second};
+    }
+
+    int index = m_devices.size();
+    m_devices.emplace_back();
+    m_devices.back().address = string(address);
+    m_device_index.emplace(m_devices.back().address, index);
+    return DeviceHandle{index};
+}
+
+CommandAndStateMessageParser::DeviceHandle CommandAndStateMessageParser::findDevice(
+    string_view address) const
+{
+    auto it = m_device_index.find(address);
+    if (it == m_device_index.end()) {
+        return DeviceHandle();
+    }
+    return DeviceHandle{it->second};
+}
+
+vector<CommandAndStateMessageParser::DeviceHandle> CommandAndStateMessageParser::
+    getDevicesInMessage() const
+{
+    vector<DeviceHandle> result;
+    for (size_t i = 0; i < m_devices.size(); ++i) {
+        if (m_devices[i].in_message) {
+            result.push_back(DeviceHandle{static_cast<int>(i)});
+        }
+    }
+    return result;
+}
+
+bool CommandAndStateMessageParser::isDeviceInMessage(DeviceHandle handle) const
+{
+    return handle.isValid() && m_devices.at(handle.index).in_message;
+}
+
+string const& CommandAndStateMessageParser::getDeviceAddress(DeviceHandle handle) const
+{
+    return m_devices.at(handle.index).address;
+}
+
+int CommandAndStateMessageParser::getDeviceModel(DeviceHandle handle) const
+{
+    auto const& device = m_devices.at(handle.index);
+    return device.in_message ? device.model : DEVICE_MODEL_UNKNOWN;
+}
+
+/** The error thrown when all the fields of a state are present, but it
+ * could not be decoded
+ */
+static invalid_argument invalidTypeError(string const& address, string const& state)
+{
+    return invalid_argument("payload/devices/" + address + ": " + state +
+                            " has a field with an invalid type");
 }
 
 void CommandAndStateMessageParser::validateFieldPresent(Json::Value const& value,
@@ -28,10 +248,26 @@ void CommandAndStateMessageParser::validateFieldPresent(Json::Value const& value
     }
 }
 
+Json::Value const& CommandAndStateMessageParser::getField(Json::Value const& value,
+    string const& field_name)
+{
+    if (!value.isObject()) {
+        return Json::Value::nullSingleton();
+    }
+    auto field = value.find(field_name.data(), field_name.data() + field_name.size());
+    return field ? *field : Json::Value::nullSingleton();
+}
+
+Json::Value const& CommandAndStateMessageParser::getDeviceJson(
+    string const& device_id) const
+{
+    return getField(getField(getField(m_json_data, "payload"), "devices"), device_id);
+}
+
 void CommandAndStateMessageParser::validateMotorOverCurrentStates(string motor_field_name,
     string device_id)
 {
-    validateFieldPresent(m_json_data["payload"]["devices"][device_id][motor_field_name],
+    validateFieldPresent(getDeviceJson(device_id)[motor_field_name],
         "overcurrent",
         motor_field_name);
 }
@@ -39,21 +275,19 @@ void CommandAndStateMessageParser::validateMotorOverCurrentStates(string motor_f
 void CommandAndStateMessageParser::validateBatteryStates(string battery_field_name,
     string device_id)
 {
-    auto battery = m_json_data["payload"]["devices"][device_id][battery_field_name];
+    Json::Value const& battery = getDeviceJson(device_id)[battery_field_name];
     validateFieldPresent(battery, "percent", battery_field_name);
     validateFieldPresent(battery, "voltage", battery_field_name);
 }
 
 void CommandAndStateMessageParser::validateAuxLightIntensity(string device_id)
 {
-    validateFieldPresent(m_json_data["payload"]["devices"][device_id]["auxLight"],
-        "intensity",
-        "auxLight");
+    validateFieldPresent(getDeviceJson(device_id)["auxLight"], "intensity", "auxLight");
 }
 
 void CommandAndStateMessageParser::validateDepthAttitude(string device_id)
 {
-    auto root = m_json_data["payload"]["devices"][device_id];
+    Json::Value const& root = getDeviceJson(device_id);
     validateFieldPresent(root, "depth", "payload/devices/" + device_id);
     validateFieldPresent(root, "roll", "payload/devices/" + device_id);
     validateFieldPresent(root, "pitch", "payload/devices/" + device_id);
@@ -63,7 +297,7 @@ void CommandAndStateMessageParser::validateDepthAttitude(string device_id)
 void CommandAndStateMessageParser::validateMotorStates(string device_id,
     string motor_field_name)
 {
-    auto root = m_json_data["payload"]["devices"][device_id][motor_field_name];
+    Json::Value const& root = getDeviceJson(device_id)[motor_field_name];
     validateFieldPresent(root, "pwm", motor_field_name);
     validateFieldPresent(root, "current", motor_field_name);
     validateFieldPresent(root, "rpm", motor_field_name);
@@ -71,30 +305,28 @@ void CommandAndStateMessageParser::validateMotorStates(string device_id,
 
 void CommandAndStateMessageParser::validatePoweredReelMotorState(string device_id)
 {
-    auto root = m_json_data["payload"]["devices"][device_id]["motor1Diagnostics"];
-    validateFieldPresent(root, "pwm", "motor1Diagnostics");
-    validateFieldPresent(root, "current", "motor1Diagnostics");
-    root = m_json_data["payload"]["devices"][device_id]["motor2Diagnostics"];
-    validateFieldPresent(root, "pwm", "motor2Diagnostics");
-    validateFieldPresent(root, "current", "motor2Diagnostics");
+    Json::Value const& device = getDeviceJson(device_id);
+    validateFieldPresent(device["motor1Diagnostics"], "pwm", "motor1Diagnostics");
+    validateFieldPresent(device["motor1Diagnostics"], "current", "motor1Diagnostics");
+    validateFieldPresent(device["motor2Diagnostics"], "pwm", "motor2Diagnostics");
+    validateFieldPresent(device["motor2Diagnostics"], "current", "motor2Diagnostics");
 }
 
 void CommandAndStateMessageParser::validateGrabberMotorsStates(string device_id)
 {
-    auto grabber = m_json_data["payload"]["devices"][device_id]["grabber"];
-    validateFieldPresent(grabber["openCloseMotorDiagnostics"],
-        "overcurrent",
-        "grabber openCloseMotorDiagnostics");
-    validateMotorStates(device_id, "openCloseMotorDiagnostics");
-    validateMotorStates(device_id, "rotateMotorDiagnostics");
-    validateFieldPresent(grabber["rotateMotorDiagnostics"],
-        "overcurrent",
-        "grabber rotateMotorDiagnostics");
+    Json::Value const& grabber = getDeviceJson(device_id)["grabber"];
+    for (auto motor : {"openCloseMotorDiagnostics", "rotateMotorDiagnostics"}) {
+        auto context = string("grabber ") + motor;
+        validateFieldPresent(grabber[motor], "overcurrent", context);
+        validateFieldPresent(grabber[motor], "pwm", context);
+        validateFieldPresent(grabber[motor], "current", context);
+        validateFieldPresent(grabber[motor], "rpm", context);
+    }
 }
 
 void CommandAndStateMessageParser::validateCameraHeadStates(string device_id)
 {
-    auto camera_head = m_json_data["payload"]["devices"][device_id]["cameraHead"];
+    Json::Value const& camera_head = getDeviceJson(device_id)["cameraHead"];
     validateFieldPresent(camera_head["light"], "intensity", "cameraHead light");
     validateFieldPresent(camera_head["lasers"], "enabled", "cameraHead lasers");
     validateFieldPresent(camera_head["tilt"], "position", "cameraHead tilt");
@@ -115,15 +347,13 @@ void CommandAndStateMessageParser::validateCameraHeadStates(string device_id)
 
 void CommandAndStateMessageParser::validateCameras(string device_id)
 {
-    validateFieldPresent(m_json_data["payload"]["devices"][device_id],
-        "cameras",
-        device_id);
+    validateFieldPresent(getDeviceJson(device_id), "cameras", device_id);
 }
 
 void CommandAndStateMessageParser::validateCameraFields(string device_id,
     string camera_id)
 {
-    auto json = m_json_data["payload"]["devices"][device_id]["cameras"][camera_id];
+    Json::Value const& json = getDeviceJson(device_id)["cameras"][camera_id];
     validateFieldPresent(json, "ip", camera_id);
     validateFieldPresent(json, "model", camera_id);
     validateFieldPresent(json, "type", camera_id);
@@ -136,21 +366,31 @@ void CommandAndStateMessageParser::validateStreamFields(string device_id,
     string camera_id,
     string stream_id)
 {
-    auto json = m_json_data["payload"]["devices"][device_id]["cameras"][camera_id]
-                           ["streams"][stream_id];
+    Json::Value const& json =
+        getDeviceJson(device_id)["cameras"][camera_id]["streams"][stream_id];
     validateFieldPresent(json, "active", stream_id);
 }
 
+void CommandAndStateMessageParser::validateZoomCameraFields(string const& device_id,
+    string const& camera_id)
+{
+    Json::Value const& json = getField(getDeviceJson(device_id)["cameras"], camera_id);
+    for (auto field : {"exposure", "brightness", "focus", "saturation", "sharpness"}) {
+        validateFieldPresent(json, field, camera_id);
+    }
+    validateFieldPresent(json, "zoom", camera_id);
+    validateFieldPresent(json["zoom"], "ratio", camera_id + " zoom");
+    validateFieldPresent(json["zoom"], "speed", camera_id + " zoom");
+}
+
 void CommandAndStateMessageParser::validateCPUTemperature(string device_id)
 {
-    validateFieldPresent(m_json_data["payload"]["devices"][device_id],
-        "cpuTemp",
-        device_id);
+    validateFieldPresent(getDeviceJson(device_id), "cpuTemp", device_id);
 }
 
 void CommandAndStateMessageParser::validateDriveStates(string device_id)
 {
-    auto thrust = m_json_data["payload"]["devices"][device_id]["drive"]["thrust"];
+    Json::Value const& thrust = getDeviceJson(device_id)["drive"]["thrust"];
     validateFieldPresent(thrust, "forward", "drive thrust");
     validateFieldPresent(thrust, "lateral", "drive thrust");
     validateFieldPresent(thrust, "vertical", "drive thrust");
@@ -159,7 +399,7 @@ void CommandAndStateMessageParser::validateDriveStates(string device_id)
 
 void CommandAndStateMessageParser::validateDriveModes(string device_id)
 {
-    auto modes = m_json_data["payload"]["devices"][device_id]["drive"]["modes"];
+    Json::Value const& modes = getDeviceJson(device_id)["drive"]["modes"];
     validateFieldPresent(modes, "autoStabilization", "drive modes");
     validateFieldPresent(modes, "motorsDisabled", "drive modes");
     validateFieldPresent(modes, "altitudeLock", "drive modes");
@@ -169,33 +409,27 @@ void CommandAndStateMessageParser::validateDriveModes(string device_id)
 
 void CommandAndStateMessageParser::validateLeaking(string device_id)
 {
-    validateFieldPresent(m_json_data["payload"]["devices"][device_id], "leak", device_id);
+    validateFieldPresent(getDeviceJson(device_id), "leak", device_id);
 }
 
 void CommandAndStateMessageParser::validateACConnected(string device_id)
 {
-    validateFieldPresent(m_json_data["payload"]["devices"][device_id],
-        "acConnected",
-        device_id);
+    validateFieldPresent(getDeviceJson(device_id), "acConnected", device_id);
 }
 
 void CommandAndStateMessageParser::validateEStop(string device_id)
 {
-    validateFieldPresent(m_json_data["payload"]["devices"][device_id],
-        "eStop",
-        device_id);
+    validateFieldPresent(getDeviceJson(device_id), "eStop", device_id);
 }
 
 void CommandAndStateMessageParser::validateDistance(string device_id)
 {
-    validateFieldPresent(m_json_data["payload"]["devices"][device_id],
-        "distance",
-        device_id);
+    validateFieldPresent(getDeviceJson(device_id), "distance", device_id);
 }
 
 void CommandAndStateMessageParser::validateTimeUsage(string device_id)
 {
-    validateFieldPresent(m_json_data["payload"]["devices"][device_id]["usageTime"],
+    validateFieldPresent(getDeviceJson(device_id)["usageTime"],
         "currentSeconds",
         "usageTime");
 }
@@ -203,7 +437,7 @@ void CommandAndStateMessageParser::validateTimeUsage(string device_id)
 void CommandAndStateMessageParser::validateRevolutionMotorStates(string device_id,
     string motor)
 {
-    auto device = m_json_data["payload"]["devices"][device_id];
+    Json::Value const& device = getDeviceJson(device_id);
     validateFieldPresent(device[motor], "pwm", motor);
     validateFieldPresent(device[motor], "current", motor);
     validateFieldPresent(device[motor], "rpm", motor);
@@ -227,15 +461,7 @@ string CommandAndStateMessageParser::parseDriveModeRevolutionCommandMessage(
     DriveMode command)
 {
     auto message = payloadSetMessageTemplate(api_version, address, model);
-    auto root = message["payload"]["devices"][address];
-
-    auto modes = root["drive"]["modes"];
-    modes["altitudeLock"] = command.altitude_lock;
-    modes["depthLock"] = command.depth_lock;
-    modes["headingLock"] = command.heading_lock;
-    root["drive"]["modes"] = modes;
-
-    message["payload"]["devices"][address] = root;
+    writeDriveModes(message["payload"]["devices"][address], command);
     Json::FastWriter fast;
     return fast.write(message);
 }
@@ -247,10 +473,7 @@ string CommandAndStateMessageParser::parseMotorsDisabledRevolutionCommandMessage
     bool motors_disabled)
 {
     auto message = payloadSetMessageTemplate(api_version, address, model);
-    auto root = message["payload"]["devices"][address];
-    root["drive"]["modes"]["motorsDisabled"] = motors_disabled;
-
-    message["payload"]["devices"][address] = root;
+    writeMotorsDisabled(message["payload"]["devices"][address], motors_disabled);
     Json::FastWriter fast;
     return fast.write(message);
 }
@@ -262,11 +485,7 @@ string CommandAndStateMessageParser::parseAutoStabilizationRevolutionCommandMess
     bool auto_stabilization)
 {
     auto message = payloadSetMessageTemplate(api_version, address, model);
-    auto root = message["payload"]["devices"][address];
-
-    root["drive"]["modes"]["autoStabilization"] = auto_stabilization;
-
-    message["payload"]["devices"][address] = root;
+    writeAutoStabilization(message["payload"]["devices"][address], auto_stabilization);
     Json::FastWriter fast;
     return fast.write(message);
 }
@@ -278,17 +497,7 @@ string CommandAndStateMessageParser::parseDriveRevolutionCommandMessage(
     commands::LinearAngular6DCommand const& command)
 {
     auto message = payloadSetMessageTemplate(api_version, address, model);
-    auto root = message["payload"]["devices"][address];
-
-    auto vertical_cmd = command.z();
-    auto thrust = root["drive"]["thrust"];
-    thrust["forward"] = round(min(max(command.linear.x(), -1.0), 1.0) * 100);
-    thrust["lateral"] = -round(min(max(command.linear.y(), -1.0), 1.0) * 100);
-    thrust["vertical"] = -round(min(max(vertical_cmd, -1.0), 1.0) * 100);
-    thrust["yaw"] = -round(min(max(command.angular.z(), -1.0), 1.0) * 100);
-    root["drive"]["thrust"] = thrust;
-
-    message["payload"]["devices"][address] = root;
+    writeDrive(message["payload"]["devices"][address], command);
     Json::FastWriter fast;
     return fast.write(message);
 }
@@ -299,11 +508,7 @@ string CommandAndStateMessageParser::parsePoweredReelCommandMessage(string api_v
     samples::Joints command)
 {
     Json::Value message = payloadSetMessageTemplate(api_version, address, model);
-    auto root = message["payload"]["devices"][address];
-    root["speed"] =
-        round(min(max(static_cast<double>(command.elements[0].speed), -1.0), 1.0) * 100);
-    message["payload"]["devices"][address] = root;
-
+    writePoweredReel(message["payload"]["devices"][address], command);
     Json::FastWriter fast;
     return fast.write(message);
 }
@@ -315,11 +520,7 @@ string CommandAndStateMessageParser::parseGrabberCommandMessage(string api_versi
     Json::Value message;
     message["apiVersion"] = api_version;
     message["method"] = "SET";
-    message["payload"]["devices"][address]["grabber"]["openClose"] =
-        min(max(static_cast<double>(command.elements[0].raw), -1.0), 1.0) * 100;
-    message["payload"]["devices"][address]["grabber"]["rotate"] =
-        min(max(static_cast<double>(command.elements[1].raw), -1.0), 1.0) * 100;
-
+    writeGrabber(message["payload"]["devices"][address], command);
     Json::FastWriter fast;
     return fast.write(message);
 }
@@ -331,11 +532,9 @@ string CommandAndStateMessageParser::parseCameraHeadLightMessage(string api_vers
     double light_intensity)
 {
     auto message = payloadSetMessageTemplate(api_version, address, model);
-    auto camera_head = message["payload"]["devices"][address]["cameraHead"];
-    camera_head["model"] = camera_head_model;
-    camera_head["light"]["intensity"] = round(min(max(light_intensity, 0.0), 1.0) * 100);
-    message["payload"]["devices"][address]["cameraHead"] = camera_head;
-
+    writeCameraHeadLight(message["payload"]["devices"][address],
+        camera_head_model,
+        light_intensity);
     Json::FastWriter fast;
     return fast.write(message);
 }
@@ -347,11 +546,9 @@ string CommandAndStateMessageParser::parseCameraHeadLaserMessage(string api_vers
     bool enabled)
 {
     auto message = payloadSetMessageTemplate(api_version, address, model);
-    auto camera_head = message["payload"]["devices"][address]["cameraHead"];
-    camera_head["model"] = camera_head_model;
-    camera_head["laser"]["enabled"] = enabled;
-    message["payload"]["devices"][address]["cameraHead"] = camera_head;
-
+    writeCameraHeadLaser(message["payload"]["devices"][address],
+        camera_head_model,
+        enabled);
     Json::FastWriter fast;
     return fast.write(message);
 }
@@ -362,9 +559,20 @@ string CommandAndStateMessageParser::parseAuxLightCommandMessage(string api_vers
     double intensity)
 {
     auto message = payloadSetMessageTemplate(api_version, address, model);
-    message["payload"]["devices"][address]["auxLight"]["intensity"] =
-        round(min(max(intensity, 0.0), 1.0) * 100);
+    writeAuxLight(message["payload"]["devices"][address], intensity);
+    Json::FastWriter fast;
+    return fast.write(message);
+}
 
+string CommandAndStateMessageParser::parseZoomCameraCommandMessage(
+    string const& api_version,
+    string const& address,
+    int model,
+    string const& camera_id,
+    TamronHarrierZoomCameraCommand const& command)
+{
+    auto message = payloadSetMessageTemplate(api_version, address, model);
+    writeZoomCamera(message["payload"]["devices"][address], camera_id, command);
     Json::FastWriter fast;
     return fast.write(message);
 }
@@ -376,242 +584,901 @@ string CommandAndStateMessageParser::parseTiltCameraHeadCommandMessage(string ap
     samples::Joints tilt)
 {
     auto message = payloadSetMessageTemplate(api_version, address, rev_model);
-    auto camera_head = message["payload"]["devices"][address]["cameraHead"];
+    writeCameraHeadTilt(message["payload"]["devices"][address], camera_head_model, tilt);
+    Json::FastWriter fast;
+    return fast.write(message);
+}
+
+void CommandAndStateMessageParser::writeDriveModes(Json::Value& device,
+    DriveMode const& command)
+{
+    auto& modes = device["drive"]["modes"];
+    modes["altitudeLock"] = command.altitude_lock;
+    modes["depthLock"] = command.depth_lock;
+    modes["headingLock"] = command.heading_lock;
+}
+
+void CommandAndStateMessageParser::writeMotorsDisabled(Json::Value& device,
+    bool motors_disabled)
+{
+    device["drive"]["modes"]["motorsDisabled"] = motors_disabled;
+}
+
+void CommandAndStateMessageParser::writeAutoStabilization(Json::Value& device,
+    bool auto_stabilization)
+{
+    device["drive"]["modes"]["autoStabilization"] = auto_stabilization;
+}
+
+void CommandAndStateMessageParser::writeDrive(Json::Value& device,
+    commands::LinearAngular6DCommand const& command)
+{
+    auto vertical_cmd = command.z();
+    auto& thrust = device["drive"]["thrust"];
+    thrust["forward"] = round(min(max(command.linear.x(), -1.0), 1.0) * 100);
+    thrust["lateral"] = -round(min(max(command.linear.y(), -1.0), 1.0) * 100);
+    thrust["vertical"] = -round(min(max(vertical_cmd, -1.0), 1.0) * 100);
+    thrust["yaw"] = -round(min(max(command.angular.z(), -1.0), 1.0) * 100);
+}
+
+void CommandAndStateMessageParser::writePoweredReel(Json::Value& device,
+    samples::Joints const& command)
+{
+    device["speed"] =
+        round(min(max(static_cast<double>(command.elements[0].speed), -1.0), 1.0) * 100);
+}
+
+void CommandAndStateMessageParser::writeGrabber(Json::Value& device,
+    samples::Joints const& command)
+{
+    device["grabber"]["openClose"] =
+        min(max(static_cast<double>(command.elements[0].raw), -1.0), 1.0) * 100;
+    device["grabber"]["rotate"] =
+        min(max(static_cast<double>(command.elements[1].raw), -1.0), 1.0) * 100;
+}
+
+void CommandAndStateMessageParser::writeCameraHeadLight(Json::Value& device,
+    int camera_head_model,
+    double light_intensity)
+{
+    auto& camera_head = device["cameraHead"];
+    camera_head["model"] = camera_head_model;
+    camera_head["light"]["intensity"] = round(min(max(light_intensity, 0.0), 1.0) * 100);
+}
+
+void CommandAndStateMessageParser::writeCameraHeadLaser(Json::Value& device,
+    int camera_head_model,
+    bool enabled)
+{
+    auto& camera_head = device["cameraHead"];
+    camera_head["model"] = camera_head_model;
+    camera_head["laser"]["enabled"] = enabled;
+}
+
+void CommandAndStateMessageParser::writeAuxLight(Json::Value& device, double intensity)
+{
+    device["auxLight"]["intensity"] = round(min(max(intensity, 0.0), 1.0) * 100);
+}
+
+void CommandAndStateMessageParser::writeCameraHeadTilt(Json::Value& device,
+    int camera_head_model,
+    samples::Joints const& tilt)
+{
+    auto& camera_head = device["cameraHead"];
     camera_head["model"] = camera_head_model;
     camera_head["tilt"]["speed"] =
         round(min(max(static_cast<double>(tilt.elements[0].speed), -1.0), 1.0) * 100);
-    message["payload"]["devices"][address]["cameraHead"] = camera_head;
+}
 
-    Json::FastWriter fast;
-    return fast.write(message);
+/** Path of each zoom camera setting in its cameras/<camera_id> entry, in bit
+ * order
+ */
+static const pair<char const*, char const*> ZOOM_CAMERA_SETTING_PATHS[] = {
+    {nullptr, "exposure"},
+    {nullptr, "brightness"},
+    {nullptr, "focus"},
+    {nullptr, "saturation"},
+    {nullptr, "sharpness"},
+    {"zoom", "ratio"},
+    {"zoom", "speed"}};
+
+array<double, ZOOM_CAMERA_SETTING_COUNT> CommandAndStateMessageParser::encodeZoomCamera(
+    TamronHarrierZoomCameraCommand const& command)
+{
+    auto percent = [](float value) {
+        return round(min(max(static_cast<double>(value), 0.0), 1.0) * 100);
+    };
+
+    // 1x is fully zoomed out. The ratio is sent with a 0.1x resolution
+    double ratio = round(max(static_cast<double>(command.zoom.ratio), 1.0) * 10) / 10;
+    double speed =
+        round(min(max(static_cast<double>(command.zoom.speed), -1.0), 1.0) * 100);
+    return {percent(command.exposure),
+        percent(command.brightness),
+        percent(command.focus),
+        percent(command.saturation),
+        percent(command.sharpness),
+        ratio,
+        speed};
+}
+
+void CommandAndStateMessageParser::writeZoomCamera(Json::Value& device,
+    string const& camera_id,
+    TamronHarrierZoomCameraCommand const& command,
+    uint32_t settings)
+{
+    auto encoded = encodeZoomCamera(command);
+    auto& camera = device["cameras"][camera_id];
+    for (int i = 0; i < ZOOM_CAMERA_SETTING_COUNT; ++i) {
+        if (settings & (1 << i)) {
+            auto const& path = ZOOM_CAMERA_SETTING_PATHS[i];
+            Json::Value& parent = path.first ? camera[path.first] : camera;
+            parent[path.second] = encoded[i];
+        }
+    }
 }
 
-Time CommandAndStateMessageParser::getTimeUsage(string address)
+static const string REVOLUTION_MOTORS[] = {"frontRightMotorDiagnostics",
+    "frontLeftMotorDiagnostics",
+    "rearRightMotorDiagnostics",
+    "rearLeftMotorDiagnostics",
+    "verticalRightMotorDiagnostics",
+    "verticalLeftMotorDiagnostics"};
+
+static bool Revolution::*const REVOLUTION_MOTORS_OVERCURRENT[] = {
+    &Revolution::front_right_motor_overcurrent,
+    &Revolution::front_left_motor_overcurrent,
+    &Revolution::rear_right_motor_overcurrent,
+    &Revolution::rear_left_motor_overcurrent,
+    &Revolution::vertical_right_motor_overcurrent,
+    &Revolution::vertical_left_motor_overcurrent};
+
+bool CommandAndStateMessageParser::hasFields(Json::Value const& value,
+    initializer_list<char const*> field_names)
 {
-    validateTimeUsage(address);
-    double time =
-        m_json_data["payload"]["devices"][address]["usageTime"]["currentSeconds"]
-            .asDouble();
-    return Time::fromSeconds(time);
+    if (!value.isObject()) {
+        return false;
+    }
+    for (auto name : field_names) {
+        if (!value.isMember(name)) {
+            return false;
+        }
+    }
+    return true;
 }
 
-vector<Camera> CommandAndStateMessageParser::getCameras(string address)
+void CommandAndStateMessageParser::setStateMerging(bool enable)
 {
-    validateCameras(address);
-    vector<Camera> cameras;
-    auto cameras_json = m_json_data["payload"]["devices"][address]["cameras"];
-    for (auto camera_id : cameras_json.getMemberNames()) {
-        validateCameraFields(address, camera_id);
+    m_state_merging = enable;
+    if (!enable) {
+        m_merged_states.clear();
+    }
+}
+
+bool CommandAndStateMessageParser::getStateMerging() const
+{
+    return m_state_merging;
+}
+
+void CommandAndStateMessageParser::resetMergedStates()
+{
+    m_merged_states.clear();
+}
+
+DeviceSnapshot const& CommandAndStateMessageParser::getMergedState(
+    string const& address) const
+{
+    auto it = m_merged_states.find(address);
+    if (it == m_merged_states.end()) {
+        throw invalid_argument("no state has been received for device " + address);
+    }
+    return it->second.snapshot;
+}
+
+uint32_t CommandAndStateMessageParser::getChangedFieldGroups(
+    string const& address) const
+{
+    auto it = m_merged_states.find(address);
+    if (it == m_merged_states.end()) {
+        return 0;
+    }
+    return it->second.changed_field_groups;
+}
+
+void CommandAndStateMessageParser::mergeParsedStates(bool parse_succeeded)
+{
+    for (auto& state : m_merged_states) {
+        state.second.changed_field_groups = 0;
+    }
+    if (!parse_succeeded) {
+        return;
+    }
+
+    RawDeviceStates raw;
+    for (auto const& device : m_devices) {
+        if (!device.in_message) {
+            continue;
+        }
+        else if (device.json) {
+            raw.present.reset();
+            StreamingStateDecoder::fromJson(*device.json, raw);
+            mergeDeviceStates(device.address, raw);
+        }
+        else {
+            mergeDeviceStates(device.address, device.raw);
+        }
+    }
+}
+
+void CommandAndStateMessageParser::mergeDeviceStates(string const& address,
+    RawDeviceStates const& update)
+{
+    auto& state = m_merged_states[address];
+    state.changed_field_groups = StreamingStateDecoder::merge(update, state.raw);
+    if (state.changed_field_groups) {
+        StreamingStateDecoder::toSnapshot(state.raw, m_receive_time, state.snapshot);
+    }
+}
+
+bitset<STATE_FIELD_COUNT> CommandAndStateMessageParser::getMissingFields(
+    string const& address,
+    uint32_t field_groups)
+{
+    auto handle = findDevice(address);
+    if (!isDeviceInMessage(handle)) {
+        throw invalid_argument("device " + address + " is not in the message");
+    }
+
+    decodeSnapshot(handle);
+    return StreamingStateDecoder::missingFields(m_devices[handle.index].raw,
+        field_groups);
+}
+
+DeviceSnapshot const& CommandAndStateMessageParser::decodeSnapshot(string const& address)
+{
+    return decodeSnapshot(findDevice(address));
+}
+
+DeviceSnapshot const& CommandAndStateMessageParser::decodeSnapshot(DeviceHandle handle)
+{
+    if (!isDeviceInMessage(handle)) {
+        return m_empty_snapshot;
+    }
+
+    auto& device = m_devices[handle.index];
+    if (!device.decoded) {
+        decodeDevice(device);
+        decodeCameras(*device.json, device);
+        device.decoded = true;
+    }
+    return device.snapshot;
+}
+
+void CommandAndStateMessageParser::decodeDevice(IndexedDevice& device)
+{
+    device.raw.present.reset();
+    if (device.json->isObject()) {
+        StreamingStateDecoder::fromJson(*device.json, device.raw);
+    }
+    StreamingStateDecoder::toSnapshot(device.raw, m_receive_time, device.snapshot);
+}
+
+void CommandAndStateMessageParser::decodeCameras(Json::Value const& device,
+    IndexedDevice& indexed)
+{
+    auto& snapshot = indexed.snapshot;
+    auto& cameras = snapshot.revolution.cameras;
+    indexed.cameras_changed = false;
+    indexed.camera_stream_changes.clear();
+
+    Json::Value const& cameras_json = getField(device, "cameras");
+    if (!cameras_json.isObject()) {
+        return;
+    }
+
+    // FNV-1a offset basis
+    uint64_t fingerprint = fingerprintJson(cameras_json, 0xcbf29ce484222325ULL);
+    if (indexed.cameras_valid && fingerprint == indexed.cameras_fingerprint) {
+        for (auto& cam : cameras) {
+            cam.time = snapshot.time;
+        }
+        snapshot.field_groups |= FIELD_GROUP_CAMERAS;
+        return;
+    }
+
+    vector<Camera> decoded;
+    if (!decodeCameraList(cameras_json, snapshot.time, decoded)) {
+        indexed.cameras_valid = false;
+        return;
+    }
+
+    if (indexed.cameras_valid) {
+        diffActiveStreams(cameras, decoded, indexed.camera_stream_changes);
+    }
+    else {
+        diffActiveStreams(vector<Camera>(), decoded, indexed.camera_stream_changes);
+    }
+    cameras.swap(decoded);
+    indexed.cameras_fingerprint = fingerprint;
+    indexed.cameras_valid = true;
+    indexed.cameras_changed = true;
+    snapshot.field_groups |= FIELD_GROUP_CAMERAS;
+}
+
+bool CommandAndStateMessageParser::decodeCameraList(Json::Value const& cameras_json,
+    Time const& time,
+    vector<Camera>& cameras)
+{
+    for (auto it = cameras_json.begin(); it != cameras_json.end(); ++it) {
+        Json::Value const& camera_json = *it;
+        if (!hasFields(camera_json, {"ip", "model", "type", "osd", "streams"}) ||
+            !hasFields(camera_json["osd"], {"enabled"})) {
+            return false;
+        }
+
         Camera cam;
-        cam.time = Time::now();
-        cam.id = camera_id;
-        cam.ip = cameras_json[camera_id]["ip"].asString();
-        cam.type = cameras_json[camera_id]["type"].asString();
-        cam.osd_enabled = cameras_json[camera_id]["osd"]["enabled"].asBool();
-        auto streams = cameras_json[camera_id]["streams"];
-        for (auto stream : streams.getMemberNames()) {
-            validateStreamFields(address, camera_id, stream);
-            if (streams[stream]["active"].asBool()) {
-                cam.active_streams.push_back(stream);
+        cam.time = time;
+        cam.id = it.name();
+        cam.ip = camera_json["ip"].asString();
+        cam.type = camera_json["type"].asString();
+        cam.osd_enabled = camera_json["osd"]["enabled"].asBool();
+        Json::Value const& streams = camera_json["streams"];
+        if (!streams.isObject()) {
+            return false;
+        }
+        for (auto stream = streams.begin(); stream != streams.end(); ++stream) {
+            if (!hasFields(*stream, {"active"})) {
+                return false;
+            }
+            if ((*stream)["active"].asBool()) {
+                cam.active_streams.push_back(stream.name());
+            }
+        }
+        cameras.push_back(move(cam));
+    }
+    return true;
+}
+
+void CommandAndStateMessageParser::diffActiveStreams(vector<Camera> const& previous,
+    vector<Camera> const& current,
+    vector<CameraStreamChange>& changes)
+{
+    auto findCamera = [](vector<Camera> const& cameras, string const& id) {
+        auto it = find_if(cameras.begin(), cameras.end(), [&id](Camera const& cam) {
+            return cam.id == id;
+        });
+        return it == cameras.end() ? nullptr : &*it;
+    };
+    auto isActive = [](Camera const* cam, string const& stream) {
+        return cam && find(cam->active_streams.begin(),
+                          cam->active_streams.end(),
+                          stream) != cam->active_streams.end();
+    };
+
+    for (auto const& cam : current) {
+        auto previous_cam = findCamera(previous, cam.id);
+        for (auto const& stream : cam.active_streams) {
+            if (!isActive(previous_cam, stream)) {
+                changes.push_back(CameraStreamChange{cam.id, stream, true});
             }
         }
-        cameras.push_back(cam);
     }
-    return cameras;
+    for (auto const& cam : previous) {
+        auto current_cam = findCamera(current, cam.id);
+        for (auto const& stream : cam.active_streams) {
+            if (!isActive(current_cam, stream)) {
+                changes.push_back(CameraStreamChange{cam.id, stream, false});
+            }
+        }
+    }
+}
+
+/** FNV-1a hash of a JSON subtree, including its member names */
+uint64_t CommandAndStateMessageParser::fingerprintJson(Json::Value const& value,
+    uint64_t hash)
+{
+    auto hashBytes = [&hash](void const* data, size_t size) {
+        auto bytes = static_cast<uint8_t const*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * 0x100000001b3ULL;
+        }
+    };
+
+    uint8_t type = value.type();
+    hashBytes(&type, 1);
+    switch (value.type()) {
+        case Json::objectValue:
+            for (auto it = value.begin(); it != value.end(); ++it) {
+                char const* end = nullptr;
+                char const* begin = it.memberName(&end);
+                hashBytes(begin, end - begin + 1);
+                hash = fingerprintJson(*it, hash);
+            }
+            break;
+        case Json::arrayValue:
+            for (auto const& element : value) {
+                hash = fingerprintJson(element, hash);
+            }
+            break;
+        case Json::stringValue: {
+            char const* begin = nullptr;
+            char const* end = nullptr;
+            value.getString(&begin, &end);
+            hashBytes(begin, end - begin);
+            break;
+        }
+        case Json::booleanValue: {
+            uint8_t flag = value.asBool();
+            hashBytes(&flag, 1);
+            break;
+        }
+        case Json::nullValue:
+            break;
+        default: {
+            double number = value.asDouble();
+            hashBytes(&number, sizeof(number));
+            break;
+        }
+    }
+    return hash;
+}
+
+void CommandAndStateMessageParser::decodeBattery(Json::Value const& battery_json,
+    Time const& time,
+    BatteryStatus& battery)
+{
+    battery.time = time;
+    battery.charge = battery_json["percent"].asDouble() / 100;
+    battery.voltage = battery_json["voltage"].asDouble();
+}
+
+/** Set \c value from the snapshot if it has all the given field groups
+ *
+ * \c extract returns a reference to the snapshot's member, so that \c value is
+ * copy-assigned, reusing the memory it already owns
+ */
+template <typename T, typename Extract>
+static bool extractIfPresent(DeviceSnapshot const& snapshot,
+    uint32_t field_groups,
+    Extract extract,
+    T& value)
+{
+    if ((snapshot.field_groups & field_groups) != field_groups) {
+        return false;
+    }
+    value = extract(snapshot);
+    return true;
+}
+
+uint32_t CommandAndStateMessageParser::getPresentFieldGroups(string const& address)
+{
+    return decodeSnapshot(address).field_groups;
+}
+
+bool CommandAndStateMessageParser::tryGetTimeUsage(string const& address, Time& value)
+{
+    return extractIfPresent(decodeSnapshot(address),
+        FIELD_GROUP_USAGE_TIME,
+        [](DeviceSnapshot const& s) -> auto const& { return s.revolution.usage_time; },
+        value);
+}
+
+Time CommandAndStateMessageParser::getTimeUsage(string const& address)
+{
+    Time value;
+    if (!tryGetTimeUsage(address, value)) {
+        validateTimeUsage(address);
+        throw invalidTypeError(address, "time usage");
+    }
+    return value;
+}
+
+bool CommandAndStateMessageParser::tryGetCameras(string const& address,
+    vector<Camera>& value)
+{
+    return extractIfPresent(decodeSnapshot(address),
+        FIELD_GROUP_CAMERAS,
+        [](DeviceSnapshot const& s) -> auto const& { return s.revolution.cameras; },
+        value);
+}
+
+vector<Camera> CommandAndStateMessageParser::getCameras(string const& address)
+{
+    vector<Camera> value;
+    if (!tryGetCameras(address, value)) {
+        validateCameras(address);
+        Json::Value const& cameras_json = getDeviceJson(address)["cameras"];
+        for (auto const& camera_id : cameras_json.getMemberNames()) {
+            validateCameraFields(address, camera_id);
+            Json::Value const& streams = cameras_json[camera_id]["streams"];
+            for (auto const& stream : streams.getMemberNames()) {
+                validateStreamFields(address, camera_id, stream);
+            }
+        }
+        throw invalidTypeError(address, "cameras");
+    }
+    return value;
+}
+
+bool CommandAndStateMessageParser::tryGetZoomCameraStates(string const& address,
+    string const& camera_id,
+    TamronHarrierZoomCamera& value)
+{
+    Json::Value const& json = getField(getField(getDeviceJson(address), "cameras"),
+        camera_id);
+    if (!hasFields(json,
+            {"exposure", "brightness", "focus", "saturation", "sharpness", "zoom"}) ||
+        !hasFields(json["zoom"], {"ratio", "speed"})) {
+        return false;
+    }
+    for (auto field : {"exposure", "brightness", "focus", "saturation", "sharpness"}) {
+        if (!json[field].isNumeric()) {
+            return false;
+        }
+    }
+    if (!json["zoom"]["ratio"].isNumeric() || !json["zoom"]["speed"].isNumeric()) {
+        return false;
+    }
+
+    value.exposure = json["exposure"].asDouble() / 100;
+    value.brightness = json["brightness"].asDouble() / 100;
+    value.focus = json["focus"].asDouble() / 100;
+    value.saturation = json["saturation"].asDouble() / 100;
+    value.sharpness = json["sharpness"].asDouble() / 100;
+    value.zoom.ratio = json["zoom"]["ratio"].asDouble();
+    value.zoom.speed = json["zoom"]["speed"].asDouble() / 100;
+    return true;
+}
+
+TamronHarrierZoomCamera CommandAndStateMessageParser::getZoomCameraStates(
+    string const& address,
+    string const& camera_id)
+{
+    TamronHarrierZoomCamera value{};
+    if (!tryGetZoomCameraStates(address, camera_id, value)) {
+        validateCameras(address);
+        validateZoomCameraFields(address, camera_id);
+        throw invalidTypeError(address, "zoom camera states");
+    }
+    return value;
+}
+
+bool CommandAndStateMessageParser::haveCamerasChanged(string const& address)
+{
+    auto handle = findDevice(address);
+    decodeSnapshot(handle);
+    return isDeviceInMessage(handle) && m_devices[handle.index].cameras_changed;
+}
+
+vector<CameraStreamChange> const& CommandAndStateMessageParser::getCameraStreamChanges(
+    string const& address)
+{
+    static const vector<CameraStreamChange> no_changes;
+
+    auto handle = findDevice(address);
+    decodeSnapshot(handle);
+    if (!isDeviceInMessage(handle)) {
+        return no_changes;
+    }
+    return m_devices[handle.index].camera_stream_changes;
+}
+
+bool CommandAndStateMessageParser::tryGetRevolutionDriveStates(string const& address,
+    samples::RigidBodyState& value)
+{
+    return extractIfPresent(decodeSnapshot(address),
+        FIELD_GROUP_DRIVE_THRUST,
+        [](DeviceSnapshot const& s) -> auto const& {
+            return s.revolution.drive_setpoint;
+        },
+        value);
 }
 
 samples::RigidBodyState CommandAndStateMessageParser::getRevolutionDriveStates(
-    string address)
+    string const& address)
+{
+    samples::RigidBodyState value;
+    getRevolutionDriveStates(address, value);
+    return value;
+}
+
+void CommandAndStateMessageParser::getRevolutionDriveStates(string const& address,
+    samples::RigidBodyState& value)
 {
-    validateDriveStates(address);
-    auto msg_setpoint = m_json_data["payload"]["devices"][address]["drive"]["thrust"];
-    double setpoint_x = msg_setpoint["forward"].asDouble();
-    double setpoint_y = -msg_setpoint["lateral"].asDouble();
-    double setpoint_z = -msg_setpoint["vertical"].asDouble();
-    double setpoint_yaw = -msg_setpoint["yaw"].asDouble();
+    if (!tryGetRevolutionDriveStates(address, value)) {
+        validateDriveStates(address);
+        throw invalidTypeError(address, "revolution drive states");
+    }
+}
 
-    samples::RigidBodyState control;
-    control.position.x() = setpoint_x;
-    control.position.y() = setpoint_y;
-    control.position.z() = setpoint_z;
-    control.orientation = Quaterniond(AngleAxisd(setpoint_yaw, Vector3d::UnitZ()));
+bool CommandAndStateMessageParser::tryGetRevolutionDriveModes(string const& address,
+    DriveMode& value)
+{
+    return extractIfPresent(decodeSnapshot(address),
+        FIELD_GROUP_DRIVE_MODES,
+        [](DeviceSnapshot const& s) -> auto const& { return s.revolution.drive_modes; },
+        value);
+}
 
-    return control;
+DriveMode CommandAndStateMessageParser::getRevolutionDriveModes(string const& address)
+{
+    DriveMode value{};
+    if (!tryGetRevolutionDriveModes(address, value)) {
+        validateDriveModes(address);
+        throw invalidTypeError(address, "revolution drive modes");
+    }
+    return value;
 }
 
-DriveMode CommandAndStateMessageParser::getRevolutionDriveModes(string address)
+bool CommandAndStateMessageParser::tryGetRevolutionMotorsDisabled(
+    string const& address,
+    bool& value)
 {
-    validateDriveModes(address);
-    DriveMode drive_mode;
-    auto root = m_json_data["payload"]["devices"][address]["drive"]["modes"];
-    drive_mode.time = Time::now();
-    drive_mode.heading_lock = root["headingLock"].asBool();
-    drive_mode.depth_lock = root["depthLock"].asBool();
-    drive_mode.altitude_lock = root["altitudeLock"].asBool();
-    return drive_mode;
+    return extractIfPresent(decodeSnapshot(address),
+        FIELD_GROUP_DRIVE_MODES,
+        [](DeviceSnapshot const& s) -> auto const& {
+            return s.revolution.motors_disabled;
+        },
+        value);
 }
 
-bool CommandAndStateMessageParser::getRevolutionMotorsDisabled(string address)
+bool CommandAndStateMessageParser::getRevolutionMotorsDisabled(string const& address)
 {
-    validateDriveModes(address);
-    return m_json_data["payload"]["devices"][address]["drive"]["modes"]["motorsDisabled"]
-        .asBool();
+    bool value = false;
+    if (!tryGetRevolutionMotorsDisabled(address, value)) {
+        validateDriveModes(address);
+        throw invalidTypeError(address, "revolution motors disabled");
+    }
+    return value;
 }
 
-bool CommandAndStateMessageParser::getRevolutionAutoStabilization(string address)
+bool CommandAndStateMessageParser::tryGetRevolutionAutoStabilization(
+    string const& address,
+    bool& value)
 {
-    validateDriveModes(address);
-    return m_json_data["payload"]["devices"][address]["drive"]["modes"]
-                      ["autoStabilization"]
-                          .asBool();
+    return extractIfPresent(decodeSnapshot(address),
+        FIELD_GROUP_DRIVE_MODES,
+        [](DeviceSnapshot const& s) -> auto const& {
+            return s.revolution.auto_stabilization;
+        },
+        value);
 }
 
-samples::RigidBodyState CommandAndStateMessageParser::getRevolutionPoseZAttitude(
-    string address)
+bool CommandAndStateMessageParser::getRevolutionAutoStabilization(string const& address)
 {
-    validateDepthAttitude(address);
-    auto local_frame = m_json_data["payload"]["devices"][address];
-    double state_z = local_frame["depth"].asDouble();
-    double roll = local_frame["roll"].asDouble() * M_PI / 180;
-    double pitch = local_frame["pitch"].asDouble() * M_PI / 180;
-    double yaw = -local_frame["heading"].asDouble() * M_PI / 180;
+    bool value = false;
+    if (!tryGetRevolutionAutoStabilization(address, value)) {
+        validateDriveModes(address);
+        throw invalidTypeError(address, "revolution auto stabilization");
+    }
+    return value;
+}
 
-    samples::RigidBodyState pose;
-    pose.time = Time::now();
-    pose.position.z() = -state_z;
-    pose.cov_position(2, 2) = 1e-1;
-    pose.orientation = AngleAxisd(yaw, Vector3d::UnitZ()) *
-                       AngleAxisd(pitch, Vector3d::UnitY()) *
-                       AngleAxisd(roll, Vector3d::UnitX());
-    // 1 degree squared in radians
-    pose.cov_orientation = Matrix3d::Identity() * pow(0.0174533, 2);
+bool CommandAndStateMessageParser::tryGetRevolutionPoseZAttitude(string const& address,
+    samples::RigidBodyState& value)
+{
+    return extractIfPresent(decodeSnapshot(address),
+        FIELD_GROUP_POSE,
+        [](DeviceSnapshot const& s) -> auto const& { return s.revolution.pose; },
+        value);
+}
 
-    return pose;
+samples::RigidBodyState CommandAndStateMessageParser::getRevolutionPoseZAttitude(
+    string const& address)
+{
+    samples::RigidBodyState value;
+    getRevolutionPoseZAttitude(address, value);
+    return value;
 }
 
-samples::Joints CommandAndStateMessageParser::getPoweredReelMotorState(string address)
+void CommandAndStateMessageParser::getRevolutionPoseZAttitude(string const& address,
+    samples::RigidBodyState& value)
 {
-    validatePoweredReelMotorState(address);
+    if (!tryGetRevolutionPoseZAttitude(address, value)) {
+        validateDepthAttitude(address);
+        throw invalidTypeError(address, "depth and attitude");
+    }
+}
 
-    JointState state;
-    auto root = m_json_data["payload"]["devices"][address];
-    state.raw = root["motor1Diagnostics"]["pwm"].asFloat() / 100;
-    state.effort = root["motor1Diagnostics"]["current"].asDouble();
+bool CommandAndStateMessageParser::tryGetPoweredReelMotorState(string const& address,
+    samples::Joints& value)
+{
+    return extractIfPresent(decodeSnapshot(address),
+        FIELD_GROUP_POWERED_REEL_MOTORS,
+        [](DeviceSnapshot const& s) -> auto const& {
+            return s.powered_reel.motor_states;
+        },
+        value);
+}
 
-    samples::Joints powered;
-    powered.time = Time::now();
-    powered.elements.push_back(state);
+samples::Joints CommandAndStateMessageParser::getPoweredReelMotorState(
+    string const& address)
+{
+    samples::Joints value;
+    getPoweredReelMotorState(address, value);
+    return value;
+}
 
-    state.raw = root["motor2Diagnostics"]["pwm"].asFloat() / 100;
-    state.effort = root["motor2Diagnostics"]["current"].asDouble();
-    powered.elements.push_back(state);
+void CommandAndStateMessageParser::getPoweredReelMotorState(string const& address,
+    samples::Joints& value)
+{
+    if (!tryGetPoweredReelMotorState(address, value)) {
+        validatePoweredReelMotorState(address);
+        throw invalidTypeError(address, "powered reel motor state");
+    }
+}
 
-    return powered;
+bool CommandAndStateMessageParser::tryGetRevolutionMotorStates(string const& address,
+    samples::Joints& value)
+{
+    return extractIfPresent(decodeSnapshot(address),
+        FIELD_GROUP_REVOLUTION_MOTORS,
+        [](DeviceSnapshot const& s) -> auto const& { return s.revolution.motor_states; },
+        value);
 }
 
-samples::Joints CommandAndStateMessageParser::getRevolutionMotorStates(string address)
+samples::Joints CommandAndStateMessageParser::getRevolutionMotorStates(
+    string const& address)
 {
-    auto root = m_json_data["payload"]["devices"][address];
-    samples::Joints revolution;
-    revolution.time = Time::now();
+    samples::Joints value;
+    getRevolutionMotorStates(address, value);
+    return value;
+}
 
-    vector<string> motors{"frontRightMotorDiagnostics",
-        "frontLeftMotorDiagnostics",
-        "rearRightMotorDiagnostics",
-        "rearLeftMotorDiagnostics",
-        "verticalRightMotorDiagnostics",
-        "verticalLeftMotorDiagnostics"};
+void CommandAndStateMessageParser::getRevolutionMotorStates(string const& address,
+    samples::Joints& value)
+{
+    if (!tryGetRevolutionMotorStates(address, value)) {
+        for (auto const& motor : REVOLUTION_MOTORS) {
+            validateRevolutionMotorStates(address, motor);
+        }
+        throw invalidTypeError(address, "revolution motor states");
+    }
+}
 
-    for (auto motor : motors) {
-        validateRevolutionMotorStates(address, motor);
-        auto motor_json = root[motor];
-        JointState state = motorDiagnosticsToJointState(motor_json);
-        revolution.elements.push_back(state);
+bool CommandAndStateMessageParser::tryGetBatteryStates(string const& address,
+    string const& battery_side,
+    BatteryStatus& value)
+{
+    auto const& snapshot = decodeSnapshot(address);
+    if (battery_side == "battery1") {
+        return extractIfPresent(snapshot,
+            FIELD_GROUP_BATTERY_1,
+            [](DeviceSnapshot const& s) -> auto const& {
+                return s.powered_reel.battery_1;
+            },
+            value);
     }
-    return revolution;
+    else if (battery_side == "battery2") {
+        return extractIfPresent(snapshot,
+            FIELD_GROUP_BATTERY_2,
+            [](DeviceSnapshot const& s) -> auto const& {
+                return s.powered_reel.battery_2;
+            },
+            value);
+    }
+    return false;
 }
 
-BatteryStatus CommandAndStateMessageParser::getBatteryStates(string address,
-    string battery_side)
+BatteryStatus CommandAndStateMessageParser::getBatteryStates(string const& address,
+    string const& battery_side)
 {
-    validateBatteryStates(battery_side, address);
-    auto battery_json = m_json_data["payload"]["devices"][address][battery_side];
     BatteryStatus battery;
-    battery.time = Time::now();
-    battery.charge = battery_json["percent"].asDouble() / 100;
-    battery.voltage = battery_json["voltage"].asDouble();
-
+    getBatteryStates(address, battery_side, battery);
     return battery;
 }
 
-Grabber CommandAndStateMessageParser::getGrabberMotorOvercurrentStates(string address)
+void CommandAndStateMessageParser::getBatteryStates(string const& address,
+    string const& battery_side,
+    BatteryStatus& value)
 {
-    validateGrabberMotorsStates(address);
-    Grabber grabber;
+    if (tryGetBatteryStates(address, battery_side, value)) {
+        return;
+    }
+
+    validateBatteryStates(battery_side, address);
+    Json::Value const& battery = getDeviceJson(address)[battery_side];
+    bool decoded_by_snapshot = battery_side == "battery1" || battery_side == "battery2";
+    if (decoded_by_snapshot || !battery["percent"].isNumeric() ||
+        !battery["voltage"].isNumeric()) {
+        throw invalidTypeError(address, battery_side + " states");
+    }
+    decodeBattery(battery, decodeSnapshot(address).time, value);
+}
 
-    return grabber;
+Grabber CommandAndStateMessageParser::getGrabberMotorOvercurrentStates(
+    string const& address)
+{
+    return getGrabberMotorStates(address);
 }
 
-Grabber CommandAndStateMessageParser::getGrabberMotorStates(string address)
+bool CommandAndStateMessageParser::tryGetGrabberMotorStates(string const& address,
+    Grabber& value)
 {
-    validateGrabberMotorsStates(address);
-    Grabber grabber;
-    auto root = m_json_data["payload"]["devices"][address]["grabber"]
-                           ["openCloseMotorDiagnostics"];
+    return extractIfPresent(decodeSnapshot(address),
+        FIELD_GROUP_GRABBER,
+        [](DeviceSnapshot const& s) -> auto const& { return s.revolution.grabber; },
+        value);
+}
 
-    JointState open_close_joint_state = motorDiagnosticsToJointState(root);
-    samples::Joints motors;
-    grabber.motor_states.elements.push_back(open_close_joint_state);
+Grabber CommandAndStateMessageParser::getGrabberMotorStates(string const& address)
+{
+    Grabber value{};
+    getGrabberMotorStates(address, value);
+    return value;
+}
 
-    root =
-        m_json_data["payload"]["devices"][address]["grabber"]["rotateMotorDiagnostics"];
-    JointState rotate_joint = motorDiagnosticsToJointState(root);
-    grabber.motor_states.elements.push_back(rotate_joint);
+void CommandAndStateMessageParser::getGrabberMotorStates(string const& address,
+    Grabber& value)
+{
+    if (!tryGetGrabberMotorStates(address, value)) {
+        validateGrabberMotorsStates(address);
+        throw invalidTypeError(address, "grabber motor states");
+    }
+}
 
-    grabber.open_close_motor_overcurrent =
-        root["openCloseMotorDiagnostics"]["overcurrent"].asBool();
-    grabber.rotate_overcurrent = root["rotateMotorDiagnostics"]["overcurrent"].asBool();
-    return grabber;
+bool CommandAndStateMessageParser::tryGetCameraHeadStates(string const& address,
+    TiltCameraHead& value)
+{
+    return extractIfPresent(decodeSnapshot(address),
+        FIELD_GROUP_CAMERA_HEAD,
+        [](DeviceSnapshot const& s) -> auto const& { return s.revolution.camera_head; },
+        value);
 }
 
-TiltCameraHead CommandAndStateMessageParser::getCameraHeadStates(string address)
+TiltCameraHead CommandAndStateMessageParser::getCameraHeadStates(string const& address)
 {
-    validateCameraHeadStates(address);
-    TiltCameraHead camera_head;
-    auto root = m_json_data["payload"]["devices"][address]["cameraHead"];
-    camera_head.light = root["light"]["intensity"].asDouble() / 100;
-    camera_head.laser = root["lasers"]["enabled"].asBool();
-    camera_head.motor_overcurrent = root["tiltMotorDiagnostics"]["overcurrent"].asBool();
-    camera_head.leak = root["leak"].asBool();
-    camera_head.time = Time::now();
+    TiltCameraHead value{};
+    getCameraHeadStates(address, value);
+    return value;
+}
 
-    return camera_head;
+void CommandAndStateMessageParser::getCameraHeadStates(string const& address,
+    TiltCameraHead& value)
+{
+    if (!tryGetCameraHeadStates(address, value)) {
+        validateCameraHeadStates(address);
+        throw invalidTypeError(address, "camera head states");
+    }
 }
 
-samples::Joints CommandAndStateMessageParser::getCameraHeadTiltMotorState(string address)
+bool CommandAndStateMessageParser::tryGetCameraHeadTiltMotorState(
+    string const& address,
+    samples::Joints& value)
 {
-    validateCameraHeadStates(address);
-    auto root = m_json_data["payload"]["devices"][address]["cameraHead"];
+    return extractIfPresent(decodeSnapshot(address),
+        FIELD_GROUP_CAMERA_HEAD | FIELD_GROUP_POSE,
+        [](DeviceSnapshot const& s) -> auto const& {
+            return s.revolution.camera_head.motor_states;
+        },
+        value);
+}
 
-    auto camera_head2body_tilt = computeCameraHead2BodyTilt(address);
+samples::Joints CommandAndStateMessageParser::getCameraHeadTiltMotorState(
+    string const& address)
+{
+    samples::Joints value;
+    getCameraHeadTiltMotorState(address, value);
+    return value;
+}
 
-    samples::Joints motor_states;
-    motor_states.time = Time::now();
-    JointState joint_state = motorDiagnosticsToJointState(root["tiltMotorDiagnostics"]);
-    joint_state.position = camera_head2body_tilt.getRad();
-    motor_states.elements.push_back(joint_state);
-    return motor_states;
+void CommandAndStateMessageParser::getCameraHeadTiltMotorState(string const& address,
+    samples::Joints& value)
+{
+    if (!tryGetCameraHeadTiltMotorState(address, value)) {
+        validateCameraHeadStates(address);
+        validateDepthAttitude(address);
+        throw invalidTypeError(address, "camera head tilt motor state");
+    }
 }
 
 RigidBodyState CommandAndStateMessageParser::getCameraHeadTiltMotorStateRBS(
-    string address)
+    string const& address)
 {
-    validateCameraHeadStates(address);
-    auto root = m_json_data["payload"]["devices"][address]["cameraHead"];
+    auto camera_head2body_tilt = computeCameraHead2BodyTilt(address);
 
     RigidBodyState rbs;
-    rbs.time = Time::now();
-    auto camera_head2body_tilt = computeCameraHead2BodyTilt(address);
+    rbs.time = decodeSnapshot(address).time;
     rbs.position = Vector3d::Zero();
     rbs.orientation = AngleAxisd(camera_head2body_tilt.getRad(), Vector3d::UnitZ());
     rbs.sourceFrame = "deep_trekker::body2front_camera_post";
@@ -619,19 +1486,31 @@ RigidBodyState CommandAndStateMessageParser::getCameraHeadTiltMotorStateRBS(
     return rbs;
 }
 
-Angle CommandAndStateMessageParser::computeCameraHead2BodyTilt(string address)
+bool CommandAndStateMessageParser::tryComputeCameraHead2BodyTilt(string const& address,
+    Angle& value)
 {
-    validateCameraHeadStates(address);
-    validateDepthAttitude(address);
+    return extractIfPresent(decodeSnapshot(address),
+        FIELD_GROUP_CAMERA_HEAD | FIELD_GROUP_POSE,
+        [](DeviceSnapshot const& s) {
+            auto const& tilt = s.revolution.camera_head.motor_states.elements[0];
+            return Angle::fromRad(tilt.position);
+        },
+        value);
+}
 
-    auto root = m_json_data["payload"]["devices"][address];
-    auto camera_head2world_tilt =
-        root["cameraHead"]["tilt"]["position"].asDouble() * M_PI / 180;
-    auto body2world_pitch = root["pitch"].asDouble() * M_PI / 180.0;
-    return Angle::fromRad(camera_head2world_tilt - body2world_pitch);
+Angle CommandAndStateMessageParser::computeCameraHead2BodyTilt(string const& address)
+{
+    Angle value;
+    if (!tryComputeCameraHead2BodyTilt(address, value)) {
+        validateCameraHeadStates(address);
+        validateDepthAttitude(address);
+        throw invalidTypeError(address, "camera head tilt");
+    }
+    return value;
 }
 
-JointState CommandAndStateMessageParser::motorDiagnosticsToJointState(Json::Value value)
+JointState CommandAndStateMessageParser::motorDiagnosticsToJointState(
+    Json::Value const& value)
 {
     JointState joint_state;
     joint_state.raw = value["pwm"].asFloat() / 100;
@@ -641,50 +1520,170 @@ JointState CommandAndStateMessageParser::motorDiagnosticsToJointState(Json::Valu
     return joint_state;
 }
 
-bool CommandAndStateMessageParser::getMotorOvercurrentStates(string address,
-    string motor_side)
+bool CommandAndStateMessageParser::tryGetMotorOvercurrentStates(string const& address,
+    string const& motor_side,
+    bool& value)
+{
+    auto const& snapshot = decodeSnapshot(address);
+    if (snapshot.has(FIELD_GROUP_REVOLUTION_MOTORS_OVERCURRENT)) {
+        for (size_t i = 0; i < 6; ++i) {
+            if (motor_side == REVOLUTION_MOTORS[i]) {
+                value = snapshot.revolution.*REVOLUTION_MOTORS_OVERCURRENT[i];
+                return true;
+            }
+        }
+    }
+    if (snapshot.has(FIELD_GROUP_POWERED_REEL_MOTORS_OVERCURRENT)) {
+        if (motor_side == "motor1Diagnostics") {
+            value = snapshot.powered_reel.motor_1_overcurrent;
+            return true;
+        }
+        else if (motor_side == "motor2Diagnostics") {
+            value = snapshot.powered_reel.motor_2_overcurrent;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool CommandAndStateMessageParser::getMotorOvercurrentStates(string const& address,
+    string const& motor_side)
 {
+    bool value = false;
+    if (tryGetMotorOvercurrentStates(address, motor_side, value)) {
+        return value;
+    }
+
     validateMotorOverCurrentStates(motor_side, address);
-    return m_json_data["payload"]["devices"][address][motor_side]["overcurrent"].asBool();
+    Json::Value const& overcurrent = getDeviceJson(address)[motor_side]["overcurrent"];
+    bool decoded_by_snapshot =
+        motor_side == "motor1Diagnostics" || motor_side == "motor2Diagnostics" ||
+        find(begin(REVOLUTION_MOTORS), end(REVOLUTION_MOTORS), motor_side) !=
+            end(REVOLUTION_MOTORS);
+    if (decoded_by_snapshot || !overcurrent.isBool()) {
+        throw invalidTypeError(address, motor_side + " overcurrent");
+    }
+    return overcurrent.asBool();
+}
+
+bool CommandAndStateMessageParser::tryGetAuxLightIntensity(string const& address,
+    double& value)
+{
+    return extractIfPresent(decodeSnapshot(address),
+        FIELD_GROUP_AUX_LIGHT,
+        [](DeviceSnapshot const& s) -> auto const& { return s.revolution.aux_light; },
+        value);
+}
+
+double CommandAndStateMessageParser::getAuxLightIntensity(string const& address)
+{
+    double value = 0;
+    if (!tryGetAuxLightIntensity(address, value)) {
+        validateAuxLightIntensity(address);
+        throw invalidTypeError(address, "aux light intensity");
+    }
+    return value;
 }
 
-double CommandAndStateMessageParser::getAuxLightIntensity(string address)
+bool CommandAndStateMessageParser::tryGetTetherLength(string const& address,
+    double& value)
 {
-    validateAuxLightIntensity(address);
-    return m_json_data["payload"]["devices"][address]["auxLight"]["intensity"]
-               .asDouble() /
-           100;
+    return extractIfPresent(decodeSnapshot(address),
+        FIELD_GROUP_DISTANCE,
+        [](DeviceSnapshot const& s) -> auto const& {
+            return s.powered_reel.tether_length;
+        },
+        value);
 }
 
-double CommandAndStateMessageParser::getTetherLength(string address)
+double CommandAndStateMessageParser::getTetherLength(string const& address)
 {
-    validateDistance(address);
-    // Convert the distance to meters
-    return m_json_data["payload"]["devices"][address]["distance"].asDouble() / 100;
+    double value = 0;
+    if (!tryGetTetherLength(address, value)) {
+        validateDistance(address);
+        throw invalidTypeError(address, "tether length");
+    }
+    return value;
 }
 
-double CommandAndStateMessageParser::getCpuTemperature(string address)
+bool CommandAndStateMessageParser::tryGetCpuTemperature(string const& address,
+    double& value)
 {
-    validateCPUTemperature(address);
-    return m_json_data["payload"]["devices"][address]["cpuTemp"].asDouble();
+    return extractIfPresent(decodeSnapshot(address),
+        FIELD_GROUP_CPU_TEMPERATURE,
+        [](DeviceSnapshot const& s) -> auto const& {
+            return s.powered_reel.cpu_temperature;
+        },
+        value);
 }
 
-bool CommandAndStateMessageParser::isLeaking(string address)
+double CommandAndStateMessageParser::getCpuTemperature(string const& address)
 {
-    validateLeaking(address);
-    return m_json_data["payload"]["devices"][address]["leak"].asBool();
+    double value = 0;
+    if (!tryGetCpuTemperature(address, value)) {
+        validateCPUTemperature(address);
+        throw invalidTypeError(address, "CPU temperature");
+    }
+    return value;
 }
 
-bool CommandAndStateMessageParser::isACPowerConnected(string address)
+bool CommandAndStateMessageParser::tryIsLeaking(string const& address, bool& value)
 {
-    validateACConnected(address);
-    return m_json_data["payload"]["devices"][address]["acConnected"].asBool();
+    return extractIfPresent(decodeSnapshot(address),
+        FIELD_GROUP_LEAK,
+        [](DeviceSnapshot const& s) -> auto const& { return s.powered_reel.leak; },
+        value);
 }
 
-bool CommandAndStateMessageParser::isEStopEnabled(string address)
+bool CommandAndStateMessageParser::isLeaking(string const& address)
 {
-    validateEStop(address);
-    return m_json_data["payload"]["devices"][address]["eStop"].asBool();
+    bool value = false;
+    if (!tryIsLeaking(address, value)) {
+        validateLeaking(address);
+        throw invalidTypeError(address, "leak");
+    }
+    return value;
+}
+
+bool CommandAndStateMessageParser::tryIsACPowerConnected(string const& address,
+    bool& value)
+{
+    return extractIfPresent(decodeSnapshot(address),
+        FIELD_GROUP_AC_CONNECTED,
+        [](DeviceSnapshot const& s) -> auto const& {
+            return s.powered_reel.ac_power_connected;
+        },
+        value);
+}
+
+bool CommandAndStateMessageParser::isACPowerConnected(string const& address)
+{
+    bool value = false;
+    if (!tryIsACPowerConnected(address, value)) {
+        validateACConnected(address);
+        throw invalidTypeError(address, "AC power");
+    }
+    return value;
+}
+
+bool CommandAndStateMessageParser::tryIsEStopEnabled(string const& address, bool& value)
+{
+    return extractIfPresent(decodeSnapshot(address),
+        FIELD_GROUP_ESTOP,
+        [](DeviceSnapshot const& s) -> auto const& {
+            return s.powered_reel.estop_enabled;
+        },
+        value);
+}
+
+bool CommandAndStateMessageParser::isEStopEnabled(string const& address)
+{
+    bool value = false;
+    if (!tryIsEStopEnabled(address, value)) {
+        validateEStop(address);
+        throw invalidTypeError(address, "emergency stop");
+    }
+    return value;
 }
 
 Json::Value CommandAndStateMessageParser::createGetRequest(string api_version)
@@ -695,69 +1694,40 @@ Json::Value CommandAndStateMessageParser::createGetRequest(string api_version)
     return message;
 }
 
-string CommandAndStateMessageParser::getRequestForPoweredReelStates(string api_version,
-    string device_id)
+string CommandAndStateMessageParser::getRequest(string const& api_version,
+    string const& device_id,
+    uint32_t field_groups)
 {
     auto request = createGetRequest(api_version);
-    auto device = request["payload"]["devices"][device_id];
-    device["distance"] = 0;
-    device["leak"] = false;
-    device["cpuTemp"] = 0;
-    device["battery1"]["percent"] = 0;
-    device["battery1"]["voltage"] = 0;
-    device["battery2"]["percent"] = 0;
-    device["battery2"]["voltage"] = 0;
-    device["acConnected"] = false;
-    device["eStop"] = false;
-    device["motor1Diagnostics"]["overcurrent"] = false;
-    device["motor1Diagnostics"]["current"] = 0;
-    device["motor1Diagnostics"]["pwm"] = 0;
-    device["motor2Diagnostics"]["overcurrent"] = false;
-    device["motor2Diagnostics"]["current"] = 0;
-    device["motor2Diagnostics"]["pwm"] = 0;
-    request["payload"]["devices"][device_id] = device;
+    StreamingStateDecoder::writeRequestFields(field_groups,
+        request["payload"]["devices"][device_id]);
 
     Json::FastWriter writer;
     return writer.write(request);
 }
 
+string CommandAndStateMessageParser::getRequestForPoweredReelStates(string api_version,
+    string device_id)
+{
+    return getRequest(api_version,
+        device_id,
+        FIELD_GROUP_DISTANCE | FIELD_GROUP_LEAK | FIELD_GROUP_CPU_TEMPERATURE |
+            FIELD_GROUP_BATTERY_1 | FIELD_GROUP_BATTERY_2 | FIELD_GROUP_AC_CONNECTED |
+            FIELD_GROUP_ESTOP | FIELD_GROUP_POWERED_REEL_MOTORS |
+            FIELD_GROUP_POWERED_REEL_MOTORS_OVERCURRENT);
+}
+
 string CommandAndStateMessageParser::getRequestForRevolutionPoseZAttitude(
     string api_version,
     string device_id)
 {
-    auto request = createGetRequest(api_version);
-    auto device = request["payload"]["devices"][device_id];
-    device["depth"] = 0;
-    device["roll"] = 0;
-    device["pitch"] = 0;
-    device["heading"] = 0;
-    request["payload"]["devices"][device_id] = device;
-
-    Json::FastWriter writer;
-    return writer.write(request);
+    return getRequest(api_version, device_id, FIELD_GROUP_POSE);
 }
 
 string CommandAndStateMessageParser::getRequestForRevolutionCameraHead(string api_version,
     string device_id)
 {
-    auto request = createGetRequest(api_version);
-    auto device = request["payload"]["devices"][device_id];
-    device["cameraHead"]["tilt"]["position"] = 0;
-    device["cameraHead"]["light"]["intensity"] = 0;
-    device["cameraHead"]["lasers"]["enabled"] = false;
-    device["cameraHead"]["leak"] = true;
-    device["cameraHead"]["tiltMotorDiagnostics"]["overcurrent"] = true;
-    device["cameraHead"]["tiltMotorDiagnostics"]["pwm"] = 0;
-    device["cameraHead"]["tiltMotorDiagnostics"]["rpm"] = 0;
-    device["cameraHead"]["tiltMotorDiagnostics"]["current"] = 0;
-    device["depth"] = 0;
-    device["roll"] = 0;
-    device["pitch"] = 0;
-    device["heading"] = 0;
-    request["payload"]["devices"][device_id] = device;
-
-    Json::FastWriter writer;
-    return writer.write(request);
+    return getRequest(api_version, device_id, FIELD_GROUP_CAMERA_HEAD | FIELD_GROUP_POSE);
 }
 
 Json::Value CommandAndStateMessageParser::getJson() const
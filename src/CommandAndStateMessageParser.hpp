@@ -3,18 +3,42 @@
 
 #include "base/Time.hpp"
 #include "base/commands/LinearAngular6DCommand.hpp"
+#include "array"
 #include "deep_trekker/DeepTrekkerCommands.hpp"
 #include "deep_trekker/DeepTrekkerStates.hpp"
+#include "deep_trekker/DeviceSnapshot.hpp"
+#include "deep_trekker/StreamingStateDecoder.hpp"
+#include "functional"
+#include "deque"
+#include "map"
 #include "memory"
 #include "power_base/BatteryStatus.hpp"
 #include "string.h"
+#include "string_view"
+#include "unordered_map"
 #include "json/json.h"
 
 namespace deep_trekker {
     class CommandAndStateMessageParser {
     public:
+        /** How parseJSONMessage decodes the messages */
+        enum DecodeMode {
+            /** Parse the message into a JSON tree, decode the device states from
+             * the tree on demand. getJson() returns the message.
+             */
+            DECODE_DOM,
+            /** Decode the device states directly from the message text using
+             * StreamingStateDecoder. No JSON tree is built, which means that
+             * getJson() returns a null value and getCameras() always throws.
+             */
+            DECODE_STREAMING
+        };
+
         CommandAndStateMessageParser();
 
+        void setDecodeMode(DecodeMode mode);
+        DecodeMode getDecodeMode() const;
+
         std::string parseDriveModeRevolutionCommandMessage(std::string api_version,
             std::string address,
             int model,
@@ -58,47 +82,353 @@ namespace deep_trekker {
             std::string address,
             int model,
             double intensity);
+        std::string parseZoomCameraCommandMessage(std::string const& api_version,
+            std::string const& address,
+            int model,
+            std::string const& camera_id,
+            TamronHarrierZoomCameraCommand const& command);
+
+        /** Write the fields of the matching parse*Message command into the
+         * device's entry of a SET message payload
+         *
+         * They are used by the parse*Message methods themselves, and allow to
+         * combine several commands in a single message
+         */
+        static void writeDriveModes(Json::Value& device, DriveMode const& command);
+        static void writeAutoStabilization(Json::Value& device, bool auto_stabilization);
+        static void writeMotorsDisabled(Json::Value& device, bool motors_disabled);
+        static void writeDrive(Json::Value& device,
+            base::commands::LinearAngular6DCommand const& command);
+        static void writePoweredReel(Json::Value& device,
+            base::samples::Joints const& command);
+        static void writeGrabber(Json::Value& device,
+            base::samples::Joints const& command);
+        static void writeCameraHeadTilt(Json::Value& device,
+            int camera_head_model,
+            base::samples::Joints const& tilt);
+        static void writeCameraHeadLaser(Json::Value& device,
+            int camera_head_model,
+            bool enabled);
+        static void writeCameraHeadLight(Json::Value& device,
+            int camera_head_model,
+            double intensity);
+        static void writeAuxLight(Json::Value& device, double intensity);
+        /** Write the settings of a zoom camera in its cameras/<camera_id> entry
+         *
+         * @param settings the TamronHarrierZoomCameraSetting values to write, so
+         *   that only the settings that changed are sent
+         */
+        static void writeZoomCamera(Json::Value& device,
+            std::string const& camera_id,
+            TamronHarrierZoomCameraCommand const& command,
+            uint32_t settings = ZOOM_CAMERA_ALL_SETTINGS);
+
+        /** The zoom camera settings as writeZoomCamera sends them
+         *
+         * @return the encoded value of each setting, indexed by the bit number of
+         *   its TamronHarrierZoomCameraSetting value
+         */
+        static std::array<double, ZOOM_CAMERA_SETTING_COUNT> encodeZoomCamera(
+            TamronHarrierZoomCameraCommand const& command);
+
+        /** A SET message for a single device, to be filled by the write* methods
+         */
+        static Json::Value payloadSetMessageTemplate(std::string api_version,
+            std::string address,
+            int model);
+
+        /** Decode all the states of a device in the last parsed message
+         *
+         * The device subtree is walked only once per message, the result being
+         * cached until the next call to parseJSONMessage. All the get* methods
+         * read from this snapshot, and only fall back to the corresponding
+         * validate* method to report missing fields.
+         *
+         * @see DeviceSnapshot::field_groups to know which states are valid
+         */
+        DeviceSnapshot const& decodeSnapshot(std::string const& address);
+
+        /** The fields of the given field groups (FieldGroup) that are missing for
+         * a device of the last parsed message
+         *
+         * The check is done in a single pass over FIELD_DESCRIPTORS. Use
+         * StreamingStateDecoder::describeFields to report them.
+         *
+         * @throw std::invalid_argument if the device is not in the message
+         */
+        std::bitset<STATE_FIELD_COUNT> getMissingFields(std::string const& address,
+            uint32_t field_groups);
 
-        base::Time getTimeUsage(std::string address);
-
-        Grabber getGrabberMotorOvercurrentStates(std::string address);
-        power_base::BatteryStatus getBatteryStates(std::string address,
-            std::string battery_side);
-        base::samples::Joints getCameraHeadTiltMotorState(std::string address);
-        base::samples::RigidBodyState getCameraHeadTiltMotorStateRBS(std::string address);
-        base::Angle computeCameraHead2BodyTilt(std::string address);
-        TiltCameraHead getCameraHeadStates(std::string address);
-        std::vector<Camera> getCameras(std::string address);
-
-        base::samples::RigidBodyState getRevolutionDriveStates(std::string address);
-        DriveMode getRevolutionDriveModes(std::string address);
-        bool getRevolutionMotorsDisabled(std::string address);
-        bool getRevolutionAutoStabilization(std::string address);
+        /** Handle on a device of the parser's device index
+         *
+         * The devices in payload/devices are indexed once per parsed message.
+         * A handle stays valid for the lifetime of the parser, and can be used
+         * to query the same device in all subsequent messages without looking
+         * its address up again.
+         */
+        struct DeviceHandle {
+            int index = -1;
+
+            bool isValid() const
+            {
+                return index >= 0;
+            }
+        };
+
+        /** Find a device that appeared in at least one parsed message
+         *
+         * @return an invalid handle if the device was never seen
+         */
+        DeviceHandle findDevice(std::string_view address) const;
+        /** The devices present in the last parsed message */
+        std::vector<DeviceHandle> getDevicesInMessage() const;
+        /** Whether the device is present in the last parsed message */
+        bool isDeviceInMessage(DeviceHandle handle) const;
+        std::string const& getDeviceAddress(DeviceHandle handle) const;
+        /** The model field of the device in the last parsed message
+         *
+         * @return DEVICE_MODEL_UNKNOWN if the device is not in the message or
+         *   does not have a model field
+         */
+        int getDeviceModel(DeviceHandle handle) const;
+        /** @overload
+         *
+         * Returns a snapshot with no field groups if the device is not in the
+         * last parsed message
+         */
+        DeviceSnapshot const& decodeSnapshot(DeviceHandle handle);
+
+        /** Merge each parsed message into a persistent per-device state
+         *
+         * When enabled, the states of every device in a successfully parsed
+         * message are merged into a state that persists across messages. This
+         * allows to query the result of several partial GET replies at once, and
+         * to know which field groups changed with the last message. Cameras are
+         * not part of the merged state. Disabling it clears the merged states.
+         */
+        void setStateMerging(bool enable);
+        bool getStateMerging() const;
+        /** Forget the merged states of all devices */
+        void resetMergedStates();
+
+        /** The state of a device merged from all the messages parsed since state
+         * merging was enabled
+         *
+         * @throw std::invalid_argument if no message contained this device
+         * @see DeviceSnapshot::field_groups to know which states are valid
+         */
+        DeviceSnapshot const& getMergedState(std::string const& address) const;
+
+        /** The field groups (FieldGroup) of a device whose value changed, or
+         * that were received for the first time, in the last parsed message
+         */
+        uint32_t getChangedFieldGroups(std::string const& address) const;
+
+        /** The field groups (FieldGroup) of a device in the last parsed message
+         *
+         * 0 if the device is not in the message
+         */
+        uint32_t getPresentFieldGroups(std::string const& address);
+
+        /** Non-throwing variants of the getters
+         *
+         * They return false, leaving \c value untouched, when the device is not
+         * in the last parsed message or lacks some of the fields of the state.
+         * Unlike the throwing getters, they never build an error message, which
+         * makes them suitable for devices that routinely omit field groups, such
+         * as a disconnected reel.
+         */
+        bool tryGetTimeUsage(std::string const& address, base::Time& value);
+        bool tryGetCameras(std::string const& address, std::vector<Camera>& value);
+        bool tryGetRevolutionDriveStates(std::string const& address,
+            base::samples::RigidBodyState& value);
+        bool tryGetRevolutionDriveModes(std::string const& address, DriveMode& value);
+        bool tryGetRevolutionMotorsDisabled(std::string const& address, bool& value);
+        bool tryGetRevolutionAutoStabilization(std::string const& address,
+            bool& value);
+        bool tryGetRevolutionPoseZAttitude(std::string const& address,
+            base::samples::RigidBodyState& value);
+        bool tryGetPoweredReelMotorState(std::string const& address,
+            base::samples::Joints& value);
+        bool tryGetRevolutionMotorStates(std::string const& address,
+            base::samples::Joints& value);
+        bool tryGetBatteryStates(std::string const& address,
+            std::string const& battery_side,
+            power_base::BatteryStatus& value);
+        bool tryGetGrabberMotorStates(std::string const& address, Grabber& value);
+        bool tryGetCameraHeadStates(std::string const& address, TiltCameraHead& value);
+        bool tryGetCameraHeadTiltMotorState(std::string const& address,
+            base::samples::Joints& value);
+        bool tryComputeCameraHead2BodyTilt(std::string const& address,
+            base::Angle& value);
+        bool tryGetMotorOvercurrentStates(std::string const& address,
+            std::string const& motor_side,
+            bool& value);
+        bool tryGetAuxLightIntensity(std::string const& address, double& value);
+        bool tryGetTetherLength(std::string const& address, double& value);
+        bool tryGetCpuTemperature(std::string const& address, double& value);
+        bool tryIsLeaking(std::string const& address, bool& value);
+        bool tryIsACPowerConnected(std::string const& address, bool& value);
+        bool tryIsEStopEnabled(std::string const& address, bool& value);
+
+        base::Time getTimeUsage(std::string const& address);
+
+        Grabber getGrabberMotorOvercurrentStates(std::string const& address);
+        power_base::BatteryStatus getBatteryStates(std::string const& address,
+            std::string const& battery_side);
+        /** Write the battery states into a caller-owned sample
+         *
+         * Like all the fill-into overloads, it throws like the getter it overloads,
+         * and reuses the memory already owned by \c value, so that it does not
+         * allocate once \c value has been sized by a first call
+         */
+        void getBatteryStates(std::string const& address,
+            std::string const& battery_side,
+            power_base::BatteryStatus& value);
+        base::samples::Joints getCameraHeadTiltMotorState(std::string const& address);
+        void getCameraHeadTiltMotorState(std::string const& address,
+            base::samples::Joints& value);
+        base::samples::RigidBodyState getCameraHeadTiltMotorStateRBS(
+            std::string const& address);
+        base::Angle computeCameraHead2BodyTilt(std::string const& address);
+        TiltCameraHead getCameraHeadStates(std::string const& address);
+        void getCameraHeadStates(std::string const& address, TiltCameraHead& value);
+        std::vector<Camera> getCameras(std::string const& address);
+        /** The settings of a zoom camera of the device
+         *
+         * Like getCameras, it needs the JSON tree, and therefore always throws in
+         * DECODE_STREAMING mode
+         */
+        TamronHarrierZoomCamera getZoomCameraStates(std::string const& address,
+            std::string const& camera_id);
+        bool tryGetZoomCameraStates(std::string const& address,
+            std::string const& camera_id,
+            TamronHarrierZoomCamera& value);
+        /** Whether the cameras of the device changed with the last parsed message
+         *
+         * The cameras subtree is fingerprinted, and the cameras are only decoded
+         * again when the fingerprint changes. When this returns false, the
+         * cameras in the device snapshot are the ones that were already there.
+         */
+        bool haveCamerasChanged(std::string const& address);
+        /** The streams whose active state changed with the last parsed message
+         *
+         * Empty if the cameras did not change. All the active streams are reported
+         * the first time the cameras of a device are decoded.
+         */
+        std::vector<CameraStreamChange> const& getCameraStreamChanges(
+            std::string const& address);
+
+        base::samples::RigidBodyState getRevolutionDriveStates(
+            std::string const& address);
+        void getRevolutionDriveStates(std::string const& address,
+            base::samples::RigidBodyState& value);
+        DriveMode getRevolutionDriveModes(std::string const& address);
+        bool getRevolutionMotorsDisabled(std::string const& address);
+        bool getRevolutionAutoStabilization(std::string const& address);
         /**
          * @see RevolutionBodyStates
          */
-        base::samples::RigidBodyState getRevolutionPoseZAttitude(std::string address);
+        base::samples::RigidBodyState getRevolutionPoseZAttitude(
+            std::string const& address);
+        void getRevolutionPoseZAttitude(std::string const& address,
+            base::samples::RigidBodyState& value);
         /**
          * @see GrabberMotorStates
          */
-        Grabber getGrabberMotorStates(std::string address);
+        Grabber getGrabberMotorStates(std::string const& address);
+        void getGrabberMotorStates(std::string const& address, Grabber& value);
         /**
          * @see PoweredReelMotorStates
          */
-        base::samples::Joints getPoweredReelMotorState(std::string address);
+        base::samples::Joints getPoweredReelMotorState(std::string const& address);
+        void getPoweredReelMotorState(std::string const& address,
+            base::samples::Joints& value);
         /**
          * @see RevolutionMotorStates
          */
-        base::samples::Joints getRevolutionMotorStates(std::string address);
-        base::JointState motorDiagnosticsToJointState(Json::Value value);
-        double getAuxLightIntensity(std::string address);
-        double getCpuTemperature(std::string address);
-        double getTetherLength(std::string address);
-        bool getMotorOvercurrentStates(std::string address, std::string motor_side);
-        bool isACPowerConnected(std::string address);
-        bool isEStopEnabled(std::string address);
-        bool isLeaking(std::string address);
+        base::samples::Joints getRevolutionMotorStates(std::string const& address);
+        void getRevolutionMotorStates(std::string const& address,
+            base::samples::Joints& value);
+        base::JointState motorDiagnosticsToJointState(Json::Value const& value);
+        double getAuxLightIntensity(std::string const& address);
+        double getCpuTemperature(std::string const& address);
+        double getTetherLength(std::string const& address);
+        bool getMotorOvercurrentStates(std::string const& address,
+            std::string const& motor_side);
+        bool isACPowerConnected(std::string const& address);
+        bool isEStopEnabled(std::string const& address);
+        bool isLeaking(std::string const& address);
+
+        /** Parse a NUL-terminated message */
         bool parseJSONMessage(char const* data, std::string& errors);
+        /** Parse a message that is not necessarily NUL-terminated
+         *
+         * The buffer is parsed in place, and is not referenced anymore once the
+         * method returns.
+         */
+        bool parseJSONMessage(std::string_view data, std::string& errors);
+        /** @overload */
+        bool parseJSONMessage(char const* data, size_t length, std::string& errors);
+        /** Parse a message, giving the time at which it was received
+         *
+         * All the samples decoded from this message are stamped with
+         * \c receive_time. The overloads without it use the time at which
+         * parseJSONMessage is called.
+         *
+         * @see SynchronousWebSocket::OnTimestampedJSONMessage
+         */
+        bool parseJSONMessage(std::string_view data,
+            base::Time const& receive_time,
+            std::string& errors);
+        /** @overload */
+        bool parseJSONMessage(char const* data,
+            size_t length,
+            base::Time const& receive_time,
+            std::string& errors);
+
+        /** The reception time of the last parsed message */
+        base::Time getReceiveTime() const;
+        /** The method field of the last parsed message, e.g. "GET" or "SET"
+         *
+         * Empty if the message has none
+         */
+        std::string const& getMethod() const;
+        /** Time elapsed between the reception of the last message and the end of
+         * its parsing
+         *
+         * In streaming mode, this covers the decoding of all the device states. In
+         * DOM mode, the device states are decoded on demand and are not included.
+         */
+        base::Time getDecodeLatency() const;
+
+        /** Function called by parseJSONRecords after each successfully parsed
+         * record, while the parser holds the states of that record
+         */
+        typedef std::function<void(std::string_view record)> OnRecord;
+
+        /** Parse a buffer that holds several messages separated by \c separator
+         *
+         * Each record is parsed in place, without copying it. Empty and
+         * whitespace-only records are skipped. Records that fail to parse are
+         * reported in \c errors, prefixed by their index in the buffer, and
+         * the parsing goes on with the next record. All records are stamped with
+         * the time at which parseJSONRecords is called.
+         *
+         * @return false if at least one record could not be parsed
+         */
+        bool parseJSONRecords(std::string_view buffer,
+            char separator,
+            OnRecord const& on_record,
+            std::string& errors);
+
+        /** Resolve the payload/devices entry of a device in the last parsed message
+         *
+         * Unlike accessing the message with the non-const operator[], it never
+         * inserts fields. It returns a null value if the device is not in the
+         * message.
+         */
+        Json::Value const& getDeviceJson(std::string const& device_id) const;
         void validateFieldPresent(Json::Value const& value,
             std::string const& fieldName,
             std::string const& context);
@@ -114,6 +444,8 @@ namespace deep_trekker {
         void validateStreamFields(std::string device_id,
             std::string camera_id,
             std::string stream_id);
+        void validateZoomCameraFields(std::string const& device_id,
+            std::string const& camera_id);
         void validateCPUTemperature(std::string device_id);
         void validateDriveStates(std::string device_id);
         void validateDriveModes(std::string device_id);
@@ -129,6 +461,13 @@ namespace deep_trekker {
         void validatePoweredReelMotorState(std::string device_id);
 
         Json::Value createGetRequest(std::string api_version);
+        /** GET request for the given field groups (FieldGroup) of a device
+         *
+         * The fields are the ones listed in FIELD_DESCRIPTORS
+         */
+        std::string getRequest(std::string const& api_version,
+            std::string const& device_id,
+            uint32_t field_groups);
         std::string getRequestForPoweredReelStates(std::string api_version,
             std::string device_id);
         std::string getRequestForRevolutionPoseZAttitude(std::string api_version,
@@ -143,9 +482,71 @@ namespace deep_trekker {
         Json::CharReaderBuilder mRBuilder;
         std::unique_ptr<Json::CharReader> mReader;
 
-        Json::Value payloadSetMessageTemplate(std::string api_version,
-            std::string address,
-            int model);
+        /** Entry of the device index, see DeviceHandle */
+        struct IndexedDevice {
+            std::string address;
+            int model = DEVICE_MODEL_UNKNOWN;
+            bool in_message = false;
+            /** Whether snapshot has been decoded from the last parsed message */
+            bool decoded = false;
+            /** The device's subtree in m_json_data, in DOM mode only */
+            Json::Value const* json = nullptr;
+            /** The device's fields, in streaming mode only */
+            RawDeviceStates raw;
+            DeviceSnapshot snapshot;
+
+            /** Fingerprint of the cameras in snapshot, if cameras_valid is set */
+            uint64_t cameras_fingerprint = 0;
+            bool cameras_valid = false;
+            bool cameras_changed = false;
+            std::vector<CameraStreamChange> camera_stream_changes;
+        };
+        /** The indexed devices. Entries are never removed, and a deque keeps
+         * their address stable, which allows m_device_index to refer to them
+         */
+        std::deque<IndexedDevice> m_devices;
+        std::unordered_map<std::string_view, int> m_device_index;
+        DeviceSnapshot m_empty_snapshot;
+        base::Time m_receive_time;
+        std::string m_method;
+        base::Time m_parse_time;
+
+        DecodeMode m_decode_mode = DECODE_DOM;
+        StreamingStateDecoder m_streaming_decoder;
+
+        bool parseStreaming(char const* begin, char const* end, std::string& errors);
+        void indexJsonDevices();
+        DeviceHandle registerDevice(std::string_view address);
+
+        /** Persistent state of a device, see setStateMerging */
+        struct MergedDeviceState {
+            RawDeviceStates raw;
+            DeviceSnapshot snapshot;
+            uint32_t changed_field_groups = 0;
+        };
+        bool m_state_merging = false;
+        std::map<std::string, MergedDeviceState> m_merged_states;
+
+        void mergeParsedStates(bool parse_succeeded);
+        void mergeDeviceStates(std::string const& address,
+            RawDeviceStates const& update);
+
+        static Json::Value const& getField(Json::Value const& value,
+            std::string const& field_name);
+        static bool hasFields(Json::Value const& value,
+            std::initializer_list<char const*> field_names);
+        void decodeDevice(IndexedDevice& device);
+        void decodeCameras(Json::Value const& device, IndexedDevice& indexed);
+        static bool decodeCameraList(Json::Value const& cameras_json,
+            base::Time const& time,
+            std::vector<Camera>& cameras);
+        static void diffActiveStreams(std::vector<Camera> const& previous,
+            std::vector<Camera> const& current,
+            std::vector<CameraStreamChange>& changes);
+        static uint64_t fingerprintJson(Json::Value const& value, uint64_t hash);
+        static void decodeBattery(Json::Value const& battery_json,
+            base::Time const& time,
+            power_base::BatteryStatus& battery);
     };
 
 } // namespace deep_trekker
@@ -0,0 +1,243 @@
+#include "CommandEncoder.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+
+using namespace std;
+using namespace base;
+using namespace deep_trekker;
+
+MessageTemplate::MessageTemplate(Json::Value const& message, size_t placeholder_count)
+{
+    Json::FastWriter fast;
+    string rendered = fast.write(message);
+
+    vector<pair<size_t, size_t>> holes;
+    for (size_t i = 0; i < placeholder_count; ++i) {
+        string marker = fast.write(placeholder(i));
+        marker.pop_back(); // FastWriter's trailing newline
+        size_t position = rendered.find(marker);
+        if (position == string::npos) {
+            throw invalid_argument("placeholder " + to_string(i) +
+                                   " not found in the message template");
+        }
+        holes.emplace_back(position, marker.size());
+        m_order.push_back(i);
+    }
+    sort(m_order.begin(), m_order.end(), [&holes](size_t a, size_t b) {
+        return holes[a].first < holes[b].first;
+    });
+
+    size_t start = 0;
+    for (size_t index : m_order) {
+        m_parts.push_back(rendered.substr(start, holes[index].first - start));
+        start = holes[index].first + holes[index].second;
+    }
+    m_parts.push_back(rendered.substr(start));
+    m_buffer.reserve(rendered.size() + 64);
+}
+
+Json::Value MessageTemplate::placeholder(size_t index)
+{
+    return Json::Value("@@deep_trekker_placeholder_" + to_string(index) + "@@");
+}
+
+/** FastWriter's representation of the integral values between -100 and 100
+ *
+ * Json::valueToString allocates for floating-point values. Since all commands
+ * but the grabber's are rounded percentages, caching these representations is
+ * enough to avoid allocating when encoding them.
+ */
+static string const* percentString(double value)
+{
+    static const auto table = [] {
+        array<string, 201> result;
+        for (int i = 0; i < 201; ++i) {
+            result[i] = Json::valueToString(static_cast<double>(i - 100));
+        }
+        return result;
+    }();
+    static const string negative_zero = Json::valueToString(-0.0);
+
+    if (value < -100 || value > 100 || value != round(value)) {
+        return nullptr;
+    }
+    else if (value == 0 && signbit(value)) {
+        return &negative_zero;
+    }
+    return &table[static_cast<int>(value) + 100];
+}
+
+static void appendValue(Json::Value const& value, string& buffer)
+{
+    switch (value.type()) {
+        case Json::booleanValue:
+            buffer += value.asBool() ? "true" : "false";
+            break;
+        case Json::intValue:
+            buffer += Json::valueToString(value.asLargestInt());
+            break;
+        case Json::realValue: {
+            auto cached = percentString(value.asDouble());
+            buffer += cached ? *cached : Json::valueToString(value.asDouble());
+            break;
+        }
+        default:
+            throw invalid_argument("unsupported value type in message template");
+    }
+}
+
+string const& MessageTemplate::render(initializer_list<Json::Value> values)
+{
+    if (values.size() != m_order.size()) {
+        throw invalid_argument("expected " + to_string(m_order.size()) +
+                               " values to render the message template, got " +
+                               to_string(values.size()));
+    }
+
+    m_buffer.assign(m_parts[0]);
+    for (size_t i = 0; i < m_order.size(); ++i) {
+        appendValue(values.begin()[m_order[i]], m_buffer);
+        m_buffer += m_parts[i + 1];
+    }
+    return m_buffer;
+}
+
+static double toPercent(double value, double min_value)
+{
+    return round(min(max(value, min_value), 1.0) * 100);
+}
+
+CommandEncoder::CommandEncoder(string const& api_version,
+    string const& address,
+    int model,
+    int camera_head_model)
+{
+    Json::Value base_message;
+    base_message["apiVersion"] = api_version;
+    base_message["method"] = "SET";
+    base_message["payload"]["devices"][address]["model"] = model;
+
+    auto make = [&](auto fill, size_t placeholder_count) {
+        Json::Value message = base_message;
+        fill(message["payload"]["devices"][address]);
+        return MessageTemplate(message, placeholder_count);
+    };
+    auto p = &MessageTemplate::placeholder;
+
+    m_drive_modes = make(
+        [&](Json::Value& device) {
+            auto& modes = device["drive"]["modes"];
+            modes["altitudeLock"] = p(0);
+            modes["depthLock"] = p(1);
+            modes["headingLock"] = p(2);
+        },
+        3);
+    m_auto_stabilization = make(
+        [&](Json::Value& device) {
+            device["drive"]["modes"]["autoStabilization"] = p(0);
+        },
+        1);
+    m_motors_disabled = make(
+        [&](Json::Value& device) { device["drive"]["modes"]["motorsDisabled"] = p(0); },
+        1);
+    m_drive = make(
+        [&](Json::Value& device) {
+            auto& thrust = device["drive"]["thrust"];
+            thrust["forward"] = p(0);
+            thrust["lateral"] = p(1);
+            thrust["vertical"] = p(2);
+            thrust["yaw"] = p(3);
+        },
+        4);
+    m_powered_reel = make([&](Json::Value& device) { device["speed"] = p(0); }, 1);
+    m_camera_head_tilt = make(
+        [&](Json::Value& device) {
+            device["cameraHead"]["model"] = camera_head_model;
+            device["cameraHead"]["tilt"]["speed"] = p(0);
+        },
+        1);
+    m_camera_head_laser = make(
+        [&](Json::Value& device) {
+            device["cameraHead"]["model"] = camera_head_model;
+            device["cameraHead"]["laser"]["enabled"] = p(0);
+        },
+        1);
+    m_camera_head_light = make(
+        [&](Json::Value& device) {
+            device["cameraHead"]["model"] = camera_head_model;
+            device["cameraHead"]["light"]["intensity"] = p(0);
+        },
+        1);
+    m_aux_light = make(
+        [&](Json::Value& device) { device["auxLight"]["intensity"] = p(0); },
+        1);
+
+    // The grabber command does not have the device model
+    Json::Value grabber;
+    grabber["apiVersion"] = api_version;
+    grabber["method"] = "SET";
+    grabber["payload"]["devices"][address]["grabber"]["openClose"] = p(0);
+    grabber["payload"]["devices"][address]["grabber"]["rotate"] = p(1);
+    m_grabber = MessageTemplate(grabber, 2);
+}
+
+string const& CommandEncoder::encodeDriveModes(DriveMode const& command)
+{
+    return m_drive_modes.render(
+        {command.altitude_lock, command.depth_lock, command.heading_lock});
+}
+
+string const& CommandEncoder::encodeAutoStabilization(bool auto_stabilization)
+{
+    return m_auto_stabilization.render({auto_stabilization});
+}
+
+string const& CommandEncoder::encodeMotorsDisabled(bool motors_disabled)
+{
+    return m_motors_disabled.render({motors_disabled});
+}
+
+string const& CommandEncoder::encodeDrive(commands::LinearAngular6DCommand const& command)
+{
+    return m_drive.render({toPercent(command.linear.x(), -1),
+        -toPercent(command.linear.y(), -1),
+        -toPercent(command.z(), -1),
+        -toPercent(command.angular.z(), -1)});
+}
+
+string const& CommandEncoder::encodePoweredReel(samples::Joints const& command)
+{
+    return m_powered_reel.render({toPercent(command.elements[0].speed, -1)});
+}
+
+string const& CommandEncoder::encodeGrabber(samples::Joints const& command)
+{
+    // Unlike the other commands, the grabber values are not rounded
+    auto scale = [](float value) {
+        return min(max(static_cast<double>(value), -1.0), 1.0) * 100;
+    };
+    return m_grabber.render(
+        {scale(command.elements[0].raw), scale(command.elements[1].raw)});
+}
+
+string const& CommandEncoder::encodeCameraHeadTilt(samples::Joints const& tilt)
+{
+    return m_camera_head_tilt.render({toPercent(tilt.elements[0].speed, -1)});
+}
+
+string const& CommandEncoder::encodeCameraHeadLaser(bool enabled)
+{
+    return m_camera_head_laser.render({enabled});
+}
+
+string const& CommandEncoder::encodeCameraHeadLight(double intensity)
+{
+    return m_camera_head_light.render({toPercent(intensity, 0)});
+}
+
+string const& CommandEncoder::encodeAuxLight(double intensity)
+{
+    return m_aux_light.render({toPercent(intensity, 0)});
+}
@@ -0,0 +1,92 @@
+#ifndef _DEEP_TREKKER_COMMAND_ENCODER_HPP_
+#define _DEEP_TREKKER_COMMAND_ENCODER_HPP_
+
+#include "base/commands/LinearAngular6DCommand.hpp"
+#include "deep_trekker/DeepTrekkerCommands.hpp"
+#include "deep_trekker/DeepTrekkerStates.hpp"
+#include <initializer_list>
+#include <json/json.h>
+#include <string>
+#include <vector>
+
+namespace deep_trekker {
+    /** A SET message pre-rendered by Json::FastWriter, with holes for the values
+     * that change from one command to the next
+     */
+    class MessageTemplate {
+    public:
+        MessageTemplate() = default;
+
+        /** Render \c message, which contains the values returned by placeholder()
+         * for indexes 0 to placeholder_count - 1, each exactly once
+         */
+        MessageTemplate(Json::Value const& message, size_t placeholder_count);
+
+        /** The value that marks the position of the index-th variable field */
+        static Json::Value placeholder(size_t index);
+
+        /** Fill the holes with \c values, in placeholder order
+         *
+         * The values must be of the same JSON type than the ones the
+         * equivalent Json::Value would hold. The returned buffer is reused by
+         * the next call.
+         */
+        std::string const& render(std::initializer_list<Json::Value> values);
+
+    private:
+        /** The constant parts, placeholder_count + 1 of them */
+        std::vector<std::string> m_parts;
+        /** The placeholder indexes, in the order they appear in the message */
+        std::vector<size_t> m_order;
+        std::string m_buffer;
+    };
+
+    /** Encoder of the SET command messages of a given device
+     *
+     * The constant parts of the messages are rendered once at construction. The
+     * encode* methods then only format the command values into a reused buffer,
+     * which avoids any allocation in steady state (except for the grabber, whose
+     * values are not rounded to integers). Their output is byte-for-byte
+     * identical to the one of the matching
+     * CommandAndStateMessageParser::parse*Message method.
+     *
+     * The returned strings are valid until the next call to the same method.
+     */
+    class CommandEncoder {
+    public:
+        /**
+         * @param camera_head_model the model of the device's camera head, used by
+         *   the camera head commands only
+         */
+        CommandEncoder(std::string const& api_version,
+            std::string const& address,
+            int model,
+            int camera_head_model = 0);
+
+        std::string const& encodeDriveModes(DriveMode const& command);
+        std::string const& encodeAutoStabilization(bool auto_stabilization);
+        std::string const& encodeMotorsDisabled(bool motors_disabled);
+        std::string const& encodeDrive(
+            base::commands::LinearAngular6DCommand const& command);
+        std::string const& encodePoweredReel(base::samples::Joints const& command);
+        std::string const& encodeGrabber(base::samples::Joints const& command);
+        std::string const& encodeCameraHeadTilt(base::samples::Joints const& tilt);
+        std::string const& encodeCameraHeadLaser(bool enabled);
+        std::string const& encodeCameraHeadLight(double intensity);
+        std::string const& encodeAuxLight(double intensity);
+
+    private:
+        MessageTemplate m_drive_modes;
+        MessageTemplate m_auto_stabilization;
+        MessageTemplate m_motors_disabled;
+        MessageTemplate m_drive;
+        MessageTemplate m_powered_reel;
+        MessageTemplate m_grabber;
+        MessageTemplate m_camera_head_tilt;
+        MessageTemplate m_camera_head_laser;
+        MessageTemplate m_camera_head_light;
+        MessageTemplate m_aux_light;
+    };
+}
+
+#endif
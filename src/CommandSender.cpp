@@ -0,0 +1,109 @@
+#include "CommandSender.hpp"
+
+using namespace std;
+using namespace base;
+using namespace deep_trekker;
+
+CommandSender::CommandSender(CommandEncoder const& encoder,
+    Send send,
+    Time const& keepalive,
+    Time const& drive_keepalive)
+    : m_encoder(encoder)
+    , m_send(send)
+    , m_keepalive(keepalive)
+    , m_drive_keepalive(drive_keepalive)
+{
+}
+
+bool CommandSender::send(Actuator actuator, string const& message, Time const& now)
+{
+    auto& last = m_last[actuator];
+    auto const& keepalive = actuator == ACTUATOR_DRIVE ? m_drive_keepalive : m_keepalive;
+    bool keepalive_due = !keepalive.isNull() && now - last.time >= keepalive;
+    if (!last.time.isNull() && !keepalive_due && last.message == message) {
+        m_suppressed_count++;
+        return false;
+    }
+
+    m_send(message);
+    last.message = message;
+    last.time = now;
+    m_sent_count++;
+    return true;
+}
+
+bool CommandSender::sendDriveModes(DriveMode const& command, Time const& now)
+{
+    return send(ACTUATOR_DRIVE_MODES, m_encoder.encodeDriveModes(command), now);
+}
+
+bool CommandSender::sendAutoStabilization(bool auto_stabilization, Time const& now)
+{
+    return send(ACTUATOR_AUTO_STABILIZATION,
+        m_encoder.encodeAutoStabilization(auto_stabilization),
+        now);
+}
+
+bool CommandSender::sendMotorsDisabled(bool motors_disabled, Time const& now)
+{
+    return send(ACTUATOR_MOTORS_DISABLED,
+        m_encoder.encodeMotorsDisabled(motors_disabled),
+        now);
+}
+
+bool CommandSender::sendDrive(commands::LinearAngular6DCommand const& command,
+    Time const& now)
+{
+    return send(ACTUATOR_DRIVE, m_encoder.encodeDrive(command), now);
+}
+
+bool CommandSender::sendPoweredReel(samples::Joints const& command, Time const& now)
+{
+    return send(ACTUATOR_POWERED_REEL, m_encoder.encodePoweredReel(command), now);
+}
+
+bool CommandSender::sendGrabber(samples::Joints const& command, Time const& now)
+{
+    return send(ACTUATOR_GRABBER, m_encoder.encodeGrabber(command), now);
+}
+
+bool CommandSender::sendCameraHeadTilt(samples::Joints const& tilt, Time const& now)
+{
+    return send(ACTUATOR_CAMERA_HEAD_TILT, m_encoder.encodeCameraHeadTilt(tilt), now);
+}
+
+bool CommandSender::sendCameraHeadLaser(bool enabled, Time const& now)
+{
+    return send(ACTUATOR_CAMERA_HEAD_LASER,
+        m_encoder.encodeCameraHeadLaser(enabled),
+        now);
+}
+
+bool CommandSender::sendCameraHeadLight(double intensity, Time const& now)
+{
+    return send(ACTUATOR_CAMERA_HEAD_LIGHT,
+        m_encoder.encodeCameraHeadLight(intensity),
+        now);
+}
+
+bool CommandSender::sendAuxLight(double intensity, Time const& now)
+{
+    return send(ACTUATOR_AUX_LIGHT, m_encoder.encodeAuxLight(intensity), now);
+}
+
+void CommandSender::reset()
+{
+    for (auto& last : m_last) {
+        last.time = Time();
+    }
+}
+
+uint64_t CommandSender::getSentCount() const
+{
+    return m_sent_count;
+}
+
+uint64_t CommandSender::getSuppressedCount() const
+{
+    return m_suppressed_count;
+}
@@ -0,0 +1,94 @@
+#ifndef _DEEP_TREKKER_COMMAND_SENDER_HPP_
+#define _DEEP_TREKKER_COMMAND_SENDER_HPP_
+
+#include "base/Time.hpp"
+#include "deep_trekker/CommandEncoder.hpp"
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace deep_trekker {
+    /** Sends the commands of a device, suppressing the ones that did not change
+     *
+     * A command is sent only if its message differs from the last one sent for
+     * the same actuator, or if the keepalive period of the actuator elapsed
+     * since then, so that the vehicle-side watchdog stays satisfied. The drive
+     * thrust has its own, usually shorter, keepalive period.
+     *
+     * Messages are encoded by a CommandEncoder, so the comparison does not
+     * allocate.
+     */
+    class CommandSender {
+    public:
+        typedef std::function<void(std::string const&)> Send;
+
+        enum Actuator {
+            ACTUATOR_DRIVE_MODES,
+            ACTUATOR_AUTO_STABILIZATION,
+            ACTUATOR_MOTORS_DISABLED,
+            ACTUATOR_DRIVE,
+            ACTUATOR_POWERED_REEL,
+            ACTUATOR_GRABBER,
+            ACTUATOR_CAMERA_HEAD_TILT,
+            ACTUATOR_CAMERA_HEAD_LASER,
+            ACTUATOR_CAMERA_HEAD_LIGHT,
+            ACTUATOR_AUX_LIGHT,
+            ACTUATOR_COUNT
+        };
+
+        /**
+         * @param send function called with the messages that must be sent
+         * @param keepalive period at which unchanged commands are sent again. Zero
+         *   disables the keepalive
+         * @param drive_keepalive the same, for the drive thrust
+         */
+        CommandSender(CommandEncoder const& encoder,
+            Send send,
+            base::Time const& keepalive,
+            base::Time const& drive_keepalive);
+
+        /** @return true if the command was sent, false if it was suppressed */
+        bool sendDriveModes(DriveMode const& command, base::Time const& now);
+        bool sendAutoStabilization(bool auto_stabilization, base::Time const& now);
+        bool sendMotorsDisabled(bool motors_disabled, base::Time const& now);
+        bool sendDrive(base::commands::LinearAngular6DCommand const& command,
+            base::Time const& now);
+        bool sendPoweredReel(base::samples::Joints const& command,
+            base::Time const& now);
+        bool sendGrabber(base::samples::Joints const& command, base::Time const& now);
+        bool sendCameraHeadTilt(base::samples::Joints const& tilt,
+            base::Time const& now);
+        bool sendCameraHeadLaser(bool enabled, base::Time const& now);
+        bool sendCameraHeadLight(double intensity, base::Time const& now);
+        bool sendAuxLight(double intensity, base::Time const& now);
+
+        /** Forget the commands sent so far, so that the next command of each
+         * actuator is sent regardless of its value
+         *
+         * Call it after reconnecting to the vehicle
+         */
+        void reset();
+
+        uint64_t getSentCount() const;
+        uint64_t getSuppressedCount() const;
+
+    private:
+        struct LastCommand {
+            std::string message;
+            base::Time time;
+        };
+
+        CommandEncoder m_encoder;
+        Send m_send;
+        base::Time m_keepalive;
+        base::Time m_drive_keepalive;
+        std::array<LastCommand, ACTUATOR_COUNT> m_last;
+        uint64_t m_sent_count = 0;
+        uint64_t m_suppressed_count = 0;
+
+        bool send(Actuator actuator, std::string const& message, base::Time const& now);
+    };
+}
+
+#endif
@@ -0,0 +1,217 @@
+#include "DeepTrekkerApiClient.hpp"
+#include "SynchronousWebSocket.hpp"
+#include <memory>
+#include <stdexcept>
+
+using namespace std;
+using namespace base;
+using namespace deep_trekker;
+
+DeepTrekkerApiClient::DeepTrekkerApiClient(Send send,
+    Time const& timeout,
+    size_t max_in_flight)
+    : m_send(send)
+    , m_timeout(timeout)
+    , m_max_in_flight(max_in_flight)
+{
+}
+
+DeepTrekkerApiClient::DeepTrekkerApiClient(SynchronousWebSocket& websocket,
+    Time const& timeout,
+    size_t max_in_flight)
+    : DeepTrekkerApiClient([&websocket](string const& msg) { websocket.send(msg); },
+          timeout,
+          max_in_flight)
+{
+    websocket.onMessage([this](string_view msg, Time const& receive_time) {
+        handleMessage(msg, receive_time);
+    });
+}
+
+DeepTrekkerApiClient::RequestID DeepTrekkerApiClient::request(string const& request,
+    OnReply callback,
+    Time const& now)
+{
+    PendingRequest pending;
+    pending.message = request;
+    pending.callback = callback;
+
+    Completions completions;
+    RequestID id;
+    {
+        lock_guard<mutex> lock(m_mutex);
+        string errors;
+        if (!m_request_parser.parseJSONMessage(request, errors)) {
+            throw invalid_argument("invalid request: " + errors);
+        }
+        pending.method = m_request_parser.getMethod();
+        for (auto handle : m_request_parser.getDevicesInMessage()) {
+            auto const& address = m_request_parser.getDeviceAddress(handle);
+            pending.addresses.push_back(address);
+            pending.field_groups.push_back(
+                m_request_parser.getPresentFieldGroups(address));
+        }
+        if (pending.addresses.empty()) {
+            throw invalid_argument("request has no devices");
+        }
+
+        id = ++m_last_id;
+        pending.id = id;
+        m_queued.push_back(move(pending));
+        expireRequests(now, completions);
+        sendQueued(now);
+    }
+
+    for (auto& completion : completions) {
+        completion.first(completion.second);
+    }
+    return id;
+}
+
+future<DeepTrekkerApiClient::Reply> DeepTrekkerApiClient::request(string const& msg,
+    Time const& now)
+{
+    auto promise = make_shared<std::promise<Reply>>();
+    auto future = promise->get_future();
+    request(
+        msg,
+        [promise](Reply const& reply) { promise->set_value(reply); },
+        now);
+    return future;
+}
+
+void DeepTrekkerApiClient::send(string const& message)
+{
+    lock_guard<mutex> lock(m_mutex);
+    m_send(message);
+}
+
+void DeepTrekkerApiClient::sendQueued(Time const& now)
+{
+    while (!m_queued.empty() && m_in_flight.size() < m_max_in_flight) {
+        m_in_flight.push_back(move(m_queued.front()));
+        m_queued.pop_front();
+
+        auto& request = m_in_flight.back();
+        request.send_time = now;
+        m_send(request.message);
+    }
+}
+
+bool DeepTrekkerApiClient::matches(PendingRequest const& request)
+{
+    if (m_parser.getMethod() != request.method) {
+        return false;
+    }
+
+    for (size_t i = 0; i < request.addresses.size(); ++i) {
+        auto const& address = request.addresses[i];
+        if (!m_parser.isDeviceInMessage(m_parser.findDevice(address))) {
+            return false;
+        }
+        uint32_t groups = request.field_groups[i];
+        if ((m_parser.getPresentFieldGroups(address) & groups) != groups) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void DeepTrekkerApiClient::handleMessage(string_view message, Time const& receive_time)
+{
+    Completions completions;
+    OnUnsolicited on_unsolicited;
+    unique_lock<mutex> parser_lock(m_parser_mutex);
+
+    string errors;
+    bool parsed = m_parser.parseJSONMessage(message, receive_time, errors);
+    unique_lock<mutex> lock(m_mutex);
+    if (parsed) {
+        auto it = m_in_flight.begin();
+        while (it != m_in_flight.end() && !matches(*it)) {
+            ++it;
+        }
+
+        if (it != m_in_flight.end()) {
+            Reply reply;
+            reply.id = it->id;
+            reply.status = REPLY_RECEIVED;
+            reply.send_time = it->send_time;
+            reply.receive_time = receive_time;
+            for (auto const& address : it->addresses) {
+                reply.snapshots[address] = m_parser.decodeSnapshot(address);
+            }
+            completions.emplace_back(move(it->callback), move(reply));
+            m_in_flight.erase(it);
+        }
+        else {
+            on_unsolicited = m_on_unsolicited;
+        }
+    }
+
+    expireRequests(receive_time, completions);
+    sendQueued(receive_time);
+    lock.unlock();
+
+    // Only the parser stays locked while the unsolicited callback reads it, so
+    // that the callback may use the rest of the client
+    if (on_unsolicited) {
+        on_unsolicited(m_parser);
+    }
+    parser_lock.unlock();
+
+    for (auto& completion : completions) {
+        completion.first(completion.second);
+    }
+}
+
+void DeepTrekkerApiClient::expireRequests(Time const& now)
+{
+    Completions completions;
+    {
+        lock_guard<mutex> lock(m_mutex);
+        expireRequests(now, completions);
+        sendQueued(now);
+    }
+
+    for (auto& completion : completions) {
+        completion.first(completion.second);
+    }
+}
+
+void DeepTrekkerApiClient::expireRequests(Time const& now, Completions& completions)
+{
+    while (!m_in_flight.empty() && m_in_flight.front().send_time + m_timeout <= now) {
+        auto& request = m_in_flight.front();
+        Reply reply;
+        reply.id = request.id;
+        reply.status = REPLY_TIMED_OUT;
+        reply.send_time = request.send_time;
+        completions.emplace_back(move(request.callback), move(reply));
+        m_in_flight.pop_front();
+    }
+}
+
+void DeepTrekkerApiClient::onUnsolicitedMessage(OnUnsolicited callback)
+{
+    lock_guard<mutex> lock(m_mutex);
+    m_on_unsolicited = callback;
+}
+
+size_t DeepTrekkerApiClient::getInFlightCount() const
+{
+    lock_guard<mutex> lock(m_mutex);
+    return m_in_flight.size();
+}
+
+size_t DeepTrekkerApiClient::getQueuedCount() const
+{
+    lock_guard<mutex> lock(m_mutex);
+    return m_queued.size();
+}
+
+void DeepTrekkerApiClient::setDecodeMode(CommandAndStateMessageParser::DecodeMode mode)
+{
+    lock_guard<mutex> lock(m_parser_mutex);
+    m_parser.setDecodeMode(mode);
+}
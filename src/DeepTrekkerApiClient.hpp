@@ -0,0 +1,151 @@
+#ifndef _DEEP_TREKKER_DEEP_TREKKER_API_CLIENT_HPP_
+#define _DEEP_TREKKER_DEEP_TREKKER_API_CLIENT_HPP_
+
+#include "base/Time.hpp"
+#include "deep_trekker/CommandAndStateMessageParser.hpp"
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace deep_trekker {
+    class SynchronousWebSocket;
+
+    /** Client of the DT API allowing several requests in flight at the same time
+     *
+     * The DT API does not echo any request identifier. A reply is matched to the
+     * oldest request in flight with the same method, whose devices are all
+     * present in it with at least the field groups that were requested. This is
+     * the order in which the vehicle answers. Messages that match no request
+     * (e.g. state broadcasts) are passed to the unsolicited message callback.
+     *
+     * Requests beyond the maximum number of requests in flight are queued, and
+     * sent as soon as a reply or a timeout frees a slot. Timeouts are checked
+     * when a message is received and when expireRequests() is called, which must
+     * be done periodically if replies may stop coming.
+     *
+     * All methods are thread-safe. Callbacks are called without the client's
+     * lock held, from the thread that received the reply or expired the request.
+     */
+    class DeepTrekkerApiClient {
+    public:
+        typedef std::function<void(std::string const&)> Send;
+        typedef uint64_t RequestID;
+
+        enum ReplyStatus {
+            REPLY_RECEIVED,
+            REPLY_TIMED_OUT
+        };
+
+        struct Reply {
+            RequestID id = 0;
+            ReplyStatus status = REPLY_TIMED_OUT;
+            /** When the request was handed to the transport */
+            base::Time send_time;
+            /** When the reply was received, null if it timed out */
+            base::Time receive_time;
+            /** The decoded snapshots of the devices of the request */
+            std::map<std::string, DeviceSnapshot> snapshots;
+        };
+
+        typedef std::function<void(Reply const&)> OnReply;
+        typedef std::function<void(CommandAndStateMessageParser&)> OnUnsolicited;
+
+        /**
+         * @param send function called with the messages that must be sent
+         * @param timeout time after which a request in flight is considered lost
+         * @param max_in_flight maximum number of requests in flight
+         */
+        DeepTrekkerApiClient(Send send,
+            base::Time const& timeout,
+            size_t max_in_flight = 8);
+
+        /** Create a client sending and receiving through a websocket
+         *
+         * The websocket's raw message callback is replaced. The client must
+         * outlive the reception of messages by the websocket.
+         */
+        DeepTrekkerApiClient(SynchronousWebSocket& websocket,
+            base::Time const& timeout,
+            size_t max_in_flight = 8);
+
+        /** Send a request and call \c callback with its reply or timeout
+         *
+         * @param request a GET or SET message, as built by
+         *   CommandAndStateMessageParser or PollPlanner
+         * @throw std::invalid_argument if the request is not valid JSON or has
+         *   no devices
+         */
+        RequestID request(std::string const& request,
+            OnReply callback,
+            base::Time const& now = base::Time::now());
+
+        /** Send a request and return a future holding its reply */
+        std::future<Reply> request(std::string const& request,
+            base::Time const& now = base::Time::now());
+
+        /** Send a message that expects no reply, e.g. a command */
+        void send(std::string const& message);
+
+        /** Process a message received from the vehicle */
+        void handleMessage(std::string_view message, base::Time const& receive_time);
+
+        /** Complete the requests in flight whose timeout expired */
+        void expireRequests(base::Time const& now);
+
+        /** Register a callback for the messages that match no request
+         *
+         * The parser holds the message during the call. The callback may call
+         * any method of the client but handleMessage and setDecodeMode
+         */
+        void onUnsolicitedMessage(OnUnsolicited callback);
+
+        /** Number of requests sent and not yet replied to */
+        size_t getInFlightCount() const;
+        /** Number of requests waiting for a slot to be sent */
+        size_t getQueuedCount() const;
+
+        void setDecodeMode(CommandAndStateMessageParser::DecodeMode mode);
+
+    private:
+        struct PendingRequest {
+            RequestID id;
+            std::string message;
+            std::string method;
+            std::vector<std::string> addresses;
+            /** The field groups requested for each device of \c addresses */
+            std::vector<uint32_t> field_groups;
+            OnReply callback;
+            base::Time send_time;
+        };
+
+        mutable std::mutex m_mutex;
+        /** Protects m_parser, which the unsolicited callback reads without
+         * m_mutex. It is always taken before m_mutex
+         */
+        std::mutex m_parser_mutex;
+        Send m_send;
+        base::Time m_timeout;
+        size_t m_max_in_flight;
+        RequestID m_last_id = 0;
+
+        std::deque<PendingRequest> m_in_flight;
+        std::deque<PendingRequest> m_queued;
+        CommandAndStateMessageParser m_parser;
+        CommandAndStateMessageParser m_request_parser;
+        OnUnsolicited m_on_unsolicited;
+
+        typedef std::vector<std::pair<OnReply, Reply>> Completions;
+
+        void expireRequests(base::Time const& now, Completions& completions);
+        void sendQueued(base::Time const& now);
+        bool matches(PendingRequest const& request);
+    };
+}
+
+#endif
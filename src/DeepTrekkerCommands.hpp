@@ -33,6 +33,23 @@ namespace deep_trekker {
         ZoomControlCommand zoom;
     };
 
+    /** The settings of a TamronHarrierZoomCameraCommand, as a bitmask to select
+     * the ones a SET message carries
+     */
+    enum TamronHarrierZoomCameraSetting {
+        ZOOM_CAMERA_EXPOSURE = 0x01,
+        ZOOM_CAMERA_BRIGHTNESS = 0x02,
+        ZOOM_CAMERA_FOCUS = 0x04,
+        ZOOM_CAMERA_SATURATION = 0x08,
+        ZOOM_CAMERA_SHARPNESS = 0x10,
+        ZOOM_CAMERA_ZOOM_RATIO = 0x20,
+        ZOOM_CAMERA_ZOOM_SPEED = 0x40,
+        ZOOM_CAMERA_ALL_SETTINGS = 0x7f
+    };
+
+    /** Number of TamronHarrierZoomCameraSetting bits */
+    static const int ZOOM_CAMERA_SETTING_COUNT = 7;
+
     /**
      *  tilt_command (speed joint):
      *   - min: -1
@@ -74,6 +74,13 @@ namespace deep_trekker {
         std::string type;
     };
 
+    /** Change of the active state of a camera stream between two messages */
+    struct CameraStreamChange {
+        std::string camera_id;
+        std::string stream_id;
+        bool active;
+    };
+
     /**
      *  light:
      *   - min: 0
@@ -110,6 +117,7 @@ namespace deep_trekker {
      *  tether_distance (payed out tether distance, given in cm)
      */
     struct ManualReel {
+        base::Time time;
         bool leak;
         bool ready;
         double tether_length;
@@ -119,6 +127,7 @@ namespace deep_trekker {
     /**
      *  tether_distance (payed out tether distance)
      *  estop_enabled (physical button state)
+     *  motor_states: see PoweredReelMotorStates
      */
     struct PoweredReel {
         base::Time time;
@@ -131,6 +140,7 @@ namespace deep_trekker {
         double cpu_temperature;
         power_base::BatteryStatus battery_1;
         power_base::BatteryStatus battery_2;
+        base::samples::Joints motor_states;
     };
 
     /**
@@ -186,9 +196,17 @@ namespace deep_trekker {
      *   - min: 0
      *   - max: 1
      *  setpoint and state in local frame
+     *  motor_states: see RevolutionMotorStates
      */
     struct Revolution {
         base::Time time;
+        RevolutionBodyStates pose;
+        RevolutionControl drive_setpoint;
+        bool motors_disabled;
+        bool auto_stabilization;
+        base::samples::Joints motor_states;
+        TiltCameraHead camera_head;
+        Grabber grabber;
         double aux_light;
         bool front_right_motor_overcurrent;
         bool front_left_motor_overcurrent;
@@ -0,0 +1,68 @@
+#ifndef _DEEP_TREKKER_DEVICE_SNAPSHOT_HPP_
+#define _DEEP_TREKKER_DEVICE_SNAPSHOT_HPP_
+
+#include "deep_trekker/DeepTrekkerStates.hpp"
+#include <cstdint>
+
+namespace deep_trekker {
+    /** Groups of fields of a device in the payload/devices part of a DT API message
+     *
+     * A group is marked as present in a DeviceSnapshot only if all the fields that
+     * the matching validate* method of CommandAndStateMessageParser checks are in
+     * the message
+     */
+    enum FieldGroup : uint32_t {
+        FIELD_GROUP_POSE = 1 << 0,
+        FIELD_GROUP_DRIVE_THRUST = 1 << 1,
+        FIELD_GROUP_DRIVE_MODES = 1 << 2,
+        FIELD_GROUP_REVOLUTION_MOTORS = 1 << 3,
+        FIELD_GROUP_REVOLUTION_MOTORS_OVERCURRENT = 1 << 4,
+        FIELD_GROUP_CAMERA_HEAD = 1 << 5,
+        FIELD_GROUP_CAMERAS = 1 << 6,
+        FIELD_GROUP_GRABBER = 1 << 7,
+        FIELD_GROUP_AUX_LIGHT = 1 << 8,
+        FIELD_GROUP_USAGE_TIME = 1 << 9,
+        FIELD_GROUP_CPU_TEMPERATURE = 1 << 10,
+        FIELD_GROUP_LEAK = 1 << 11,
+        FIELD_GROUP_AC_CONNECTED = 1 << 12,
+        FIELD_GROUP_ESTOP = 1 << 13,
+        FIELD_GROUP_DISTANCE = 1 << 14,
+        FIELD_GROUP_BATTERY_1 = 1 << 15,
+        FIELD_GROUP_BATTERY_2 = 1 << 16,
+        FIELD_GROUP_POWERED_REEL_MOTORS = 1 << 17,
+        FIELD_GROUP_POWERED_REEL_MOTORS_OVERCURRENT = 1 << 18,
+        FIELD_GROUP_MODEL = 1 << 19
+    };
+
+    /** Known values of the model field of the devices in DT API messages */
+    enum DeviceModel {
+        DEVICE_MODEL_UNKNOWN = -1,
+        DEVICE_MODEL_POWERED_REEL = 12,
+        DEVICE_MODEL_REVOLUTION = 13
+    };
+
+    /** All the states of a single device decoded from one DT API message
+     *
+     * The same message fields are decoded in all the aggregates they are relevant
+     * for (e.g. cpuTemp is in revolution, powered_reel and manual_reel), since the
+     * message itself does not tell which kind of device the address refers to.
+     * Only the fields of the groups marked in field_groups are valid.
+     */
+    struct DeviceSnapshot {
+        base::Time time;
+        uint32_t field_groups = 0;
+        /** The device's model field, valid if FIELD_GROUP_MODEL is set */
+        int model = DEVICE_MODEL_UNKNOWN;
+
+        Revolution revolution;
+        PoweredReel powered_reel;
+        ManualReel manual_reel;
+
+        bool has(FieldGroup group) const
+        {
+            return (field_groups & group) != 0;
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,403 @@
+#ifndef _DEEP_TREKKER_FIELD_DESCRIPTORS_HPP_
+#define _DEEP_TREKKER_FIELD_DESCRIPTORS_HPP_
+
+#include "deep_trekker/DeviceSnapshot.hpp"
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <string_view>
+
+namespace deep_trekker {
+    /** Scalar fields of a device, as described by FIELD_DESCRIPTORS
+     *
+     * The fields of a motor diagnostics are always declared in the
+     * PWM, CURRENT, RPM, OVERCURRENT order
+     */
+    enum StateField {
+        STATE_FIELD_MODEL,
+
+        STATE_FIELD_DEPTH,
+        STATE_FIELD_ROLL,
+        STATE_FIELD_PITCH,
+        STATE_FIELD_HEADING,
+
+        STATE_FIELD_THRUST_FORWARD,
+        STATE_FIELD_THRUST_LATERAL,
+        STATE_FIELD_THRUST_VERTICAL,
+        STATE_FIELD_THRUST_YAW,
+
+        STATE_FIELD_MODE_AUTO_STABILIZATION,
+        STATE_FIELD_MODE_MOTORS_DISABLED,
+        STATE_FIELD_MODE_ALTITUDE_LOCK,
+        STATE_FIELD_MODE_DEPTH_LOCK,
+        STATE_FIELD_MODE_HEADING_LOCK,
+
+        STATE_FIELD_FRONT_RIGHT_MOTOR_PWM,
+        STATE_FIELD_FRONT_RIGHT_MOTOR_CURRENT,
+        STATE_FIELD_FRONT_RIGHT_MOTOR_RPM,
+        STATE_FIELD_FRONT_RIGHT_MOTOR_OVERCURRENT,
+        STATE_FIELD_FRONT_LEFT_MOTOR_PWM,
+        STATE_FIELD_FRONT_LEFT_MOTOR_CURRENT,
+        STATE_FIELD_FRONT_LEFT_MOTOR_RPM,
+        STATE_FIELD_FRONT_LEFT_MOTOR_OVERCURRENT,
+        STATE_FIELD_REAR_RIGHT_MOTOR_PWM,
+        STATE_FIELD_REAR_RIGHT_MOTOR_CURRENT,
+        STATE_FIELD_REAR_RIGHT_MOTOR_RPM,
+        STATE_FIELD_REAR_RIGHT_MOTOR_OVERCURRENT,
+        STATE_FIELD_REAR_LEFT_MOTOR_PWM,
+        STATE_FIELD_REAR_LEFT_MOTOR_CURRENT,
+        STATE_FIELD_REAR_LEFT_MOTOR_RPM,
+        STATE_FIELD_REAR_LEFT_MOTOR_OVERCURRENT,
+        STATE_FIELD_VERTICAL_RIGHT_MOTOR_PWM,
+        STATE_FIELD_VERTICAL_RIGHT_MOTOR_CURRENT,
+        STATE_FIELD_VERTICAL_RIGHT_MOTOR_RPM,
+        STATE_FIELD_VERTICAL_RIGHT_MOTOR_OVERCURRENT,
+        STATE_FIELD_VERTICAL_LEFT_MOTOR_PWM,
+        STATE_FIELD_VERTICAL_LEFT_MOTOR_CURRENT,
+        STATE_FIELD_VERTICAL_LEFT_MOTOR_RPM,
+        STATE_FIELD_VERTICAL_LEFT_MOTOR_OVERCURRENT,
+
+        STATE_FIELD_CAMERA_HEAD_LIGHT,
+        STATE_FIELD_CAMERA_HEAD_LASERS,
+        STATE_FIELD_CAMERA_HEAD_TILT,
+        STATE_FIELD_CAMERA_HEAD_LEAK,
+        STATE_FIELD_CAMERA_HEAD_TILT_MOTOR_PWM,
+        STATE_FIELD_CAMERA_HEAD_TILT_MOTOR_CURRENT,
+        STATE_FIELD_CAMERA_HEAD_TILT_MOTOR_RPM,
+        STATE_FIELD_CAMERA_HEAD_TILT_MOTOR_OVERCURRENT,
+
+        STATE_FIELD_GRABBER_OPEN_CLOSE_MOTOR_PWM,
+        STATE_FIELD_GRABBER_OPEN_CLOSE_MOTOR_CURRENT,
+        STATE_FIELD_GRABBER_OPEN_CLOSE_MOTOR_RPM,
+        STATE_FIELD_GRABBER_OPEN_CLOSE_MOTOR_OVERCURRENT,
+        STATE_FIELD_GRABBER_ROTATE_MOTOR_PWM,
+        STATE_FIELD_GRABBER_ROTATE_MOTOR_CURRENT,
+        STATE_FIELD_GRABBER_ROTATE_MOTOR_RPM,
+        STATE_FIELD_GRABBER_ROTATE_MOTOR_OVERCURRENT,
+
+        STATE_FIELD_AUX_LIGHT,
+        STATE_FIELD_USAGE_TIME,
+        STATE_FIELD_CPU_TEMPERATURE,
+        STATE_FIELD_LEAK,
+        STATE_FIELD_AC_CONNECTED,
+        STATE_FIELD_ESTOP,
+        STATE_FIELD_DISTANCE,
+        STATE_FIELD_BATTERY_1_PERCENT,
+        STATE_FIELD_BATTERY_1_VOLTAGE,
+        STATE_FIELD_BATTERY_2_PERCENT,
+        STATE_FIELD_BATTERY_2_VOLTAGE,
+
+        STATE_FIELD_REEL_MOTOR_1_PWM,
+        STATE_FIELD_REEL_MOTOR_1_CURRENT,
+        STATE_FIELD_REEL_MOTOR_1_OVERCURRENT,
+        STATE_FIELD_REEL_MOTOR_2_PWM,
+        STATE_FIELD_REEL_MOTOR_2_CURRENT,
+        STATE_FIELD_REEL_MOTOR_2_OVERCURRENT,
+
+        STATE_FIELD_COUNT
+    };
+
+    /** JSON type of a field, used to generate the placeholder values of GET
+     * requests */
+    enum FieldType {
+        FIELD_TYPE_NUMBER,
+        FIELD_TYPE_BOOL
+    };
+
+    /** Description of a StateField
+     *
+     * The decoded value of a field is its raw value multiplied by \c scale, which
+     * holds both the unit conversion and the sign convention between the DT API
+     * and the Rock frames. Booleans have a scale of 1.
+     */
+    struct FieldDescriptor {
+        StateField field;
+        FieldGroup group;
+        FieldType type;
+        double scale;
+        /** Position of the field relative to the device */
+        std::array<std::string_view, 3> path;
+    };
+
+    namespace field_scales {
+        static constexpr double DEG2RAD = M_PI / 180;
+        static constexpr double PERCENT = 0.01;
+        static constexpr double RPM2RADS = 2 * M_PI / 60;
+        static constexpr double CENTIMETERS = 0.01;
+    }
+
+#define DEEP_TREKKER_MOTOR_DIAGNOSTICS(prefix, group, overcurrent_group, ...)         \
+    {prefix##_PWM,                                                                    \
+        group,                                                                        \
+        FIELD_TYPE_NUMBER,                                                            \
+        field_scales::PERCENT,                                                        \
+        {__VA_ARGS__, "pwm"}},                                                        \
+        {prefix##_CURRENT, group, FIELD_TYPE_NUMBER, 1, {__VA_ARGS__, "current"}},    \
+        {prefix##_RPM,                                                                \
+            group,                                                                    \
+            FIELD_TYPE_NUMBER,                                                        \
+            field_scales::RPM2RADS,                                                   \
+            {__VA_ARGS__, "rpm"}},                                                    \
+        {prefix##_OVERCURRENT,                                                        \
+            overcurrent_group,                                                        \
+            FIELD_TYPE_BOOL,                                                          \
+            1,                                                                        \
+            {__VA_ARGS__, "overcurrent"}}
+
+    /** Description of all the StateField values, indexed by StateField
+     *
+     * This is the single description of the state fields of the DT API. The GET
+     * requests, the validation of the field groups and the decoding of the
+     * snapshots are all derived from it.
+     */
+    inline constexpr FieldDescriptor FIELD_DESCRIPTORS[] = {
+        {STATE_FIELD_MODEL, FIELD_GROUP_MODEL, FIELD_TYPE_NUMBER, 1, {"model"}},
+
+        {STATE_FIELD_DEPTH, FIELD_GROUP_POSE, FIELD_TYPE_NUMBER, -1, {"depth"}},
+        {STATE_FIELD_ROLL,
+            FIELD_GROUP_POSE,
+            FIELD_TYPE_NUMBER,
+            field_scales::DEG2RAD,
+            {"roll"}},
+        {STATE_FIELD_PITCH,
+            FIELD_GROUP_POSE,
+            FIELD_TYPE_NUMBER,
+            field_scales::DEG2RAD,
+            {"pitch"}},
+        {STATE_FIELD_HEADING,
+            FIELD_GROUP_POSE,
+            FIELD_TYPE_NUMBER,
+            -field_scales::DEG2RAD,
+            {"heading"}},
+
+        {STATE_FIELD_THRUST_FORWARD,
+            FIELD_GROUP_DRIVE_THRUST,
+            FIELD_TYPE_NUMBER,
+            1,
+            {"drive", "thrust", "forward"}},
+        {STATE_FIELD_THRUST_LATERAL,
+            FIELD_GROUP_DRIVE_THRUST,
+            FIELD_TYPE_NUMBER,
+            -1,
+            {"drive", "thrust", "lateral"}},
+        {STATE_FIELD_THRUST_VERTICAL,
+            FIELD_GROUP_DRIVE_THRUST,
+            FIELD_TYPE_NUMBER,
+            -1,
+            {"drive", "thrust", "vertical"}},
+        {STATE_FIELD_THRUST_YAW,
+            FIELD_GROUP_DRIVE_THRUST,
+            FIELD_TYPE_NUMBER,
+            -1,
+            {"drive", "thrust", "yaw"}},
+
+        {STATE_FIELD_MODE_AUTO_STABILIZATION,
+            FIELD_GROUP_DRIVE_MODES,
+            FIELD_TYPE_BOOL,
+            1,
+            {"drive", "modes", "autoStabilization"}},
+        {STATE_FIELD_MODE_MOTORS_DISABLED,
+            FIELD_GROUP_DRIVE_MODES,
+            FIELD_TYPE_BOOL,
+            1,
+            {"drive", "modes", "motorsDisabled"}},
+        {STATE_FIELD_MODE_ALTITUDE_LOCK,
+            FIELD_GROUP_DRIVE_MODES,
+            FIELD_TYPE_BOOL,
+            1,
+            {"drive", "modes", "altitudeLock"}},
+        {STATE_FIELD_MODE_DEPTH_LOCK,
+            FIELD_GROUP_DRIVE_MODES,
+            FIELD_TYPE_BOOL,
+            1,
+            {"drive", "modes", "depthLock"}},
+        {STATE_FIELD_MODE_HEADING_LOCK,
+            FIELD_GROUP_DRIVE_MODES,
+            FIELD_TYPE_BOOL,
+            1,
+            {"drive", "modes", "headingLock"}},
+
+        DEEP_TREKKER_MOTOR_DIAGNOSTICS(STATE_FIELD_FRONT_RIGHT_MOTOR,
+            FIELD_GROUP_REVOLUTION_MOTORS,
+            FIELD_GROUP_REVOLUTION_MOTORS_OVERCURRENT,
+            "frontRightMotorDiagnostics"),
+        DEEP_TREKKER_MOTOR_DIAGNOSTICS(STATE_FIELD_FRONT_LEFT_MOTOR,
+            FIELD_GROUP_REVOLUTION_MOTORS,
+            FIELD_GROUP_REVOLUTION_MOTORS_OVERCURRENT,
+            "frontLeftMotorDiagnostics"),
+        DEEP_TREKKER_MOTOR_DIAGNOSTICS(STATE_FIELD_REAR_RIGHT_MOTOR,
+            FIELD_GROUP_REVOLUTION_MOTORS,
+            FIELD_GROUP_REVOLUTION_MOTORS_OVERCURRENT,
+            "rearRightMotorDiagnostics"),
+        DEEP_TREKKER_MOTOR_DIAGNOSTICS(STATE_FIELD_REAR_LEFT_MOTOR,
+            FIELD_GROUP_REVOLUTION_MOTORS,
+            FIELD_GROUP_REVOLUTION_MOTORS_OVERCURRENT,
+            "rearLeftMotorDiagnostics"),
+        DEEP_TREKKER_MOTOR_DIAGNOSTICS(STATE_FIELD_VERTICAL_RIGHT_MOTOR,
+            FIELD_GROUP_REVOLUTION_MOTORS,
+            FIELD_GROUP_REVOLUTION_MOTORS_OVERCURRENT,
+            "verticalRightMotorDiagnostics"),
+        DEEP_TREKKER_MOTOR_DIAGNOSTICS(STATE_FIELD_VERTICAL_LEFT_MOTOR,
+            FIELD_GROUP_REVOLUTION_MOTORS,
+            FIELD_GROUP_REVOLUTION_MOTORS_OVERCURRENT,
+            "verticalLeftMotorDiagnostics"),
+
+        {STATE_FIELD_CAMERA_HEAD_LIGHT,
+            FIELD_GROUP_CAMERA_HEAD,
+            FIELD_TYPE_NUMBER,
+            field_scales::PERCENT,
+            {"cameraHead", "light", "intensity"}},
+        {STATE_FIELD_CAMERA_HEAD_LASERS,
+            FIELD_GROUP_CAMERA_HEAD,
+            FIELD_TYPE_BOOL,
+            1,
+            {"cameraHead", "lasers", "enabled"}},
+        {STATE_FIELD_CAMERA_HEAD_TILT,
+            FIELD_GROUP_CAMERA_HEAD,
+            FIELD_TYPE_NUMBER,
+            field_scales::DEG2RAD,
+            {"cameraHead", "tilt", "position"}},
+        {STATE_FIELD_CAMERA_HEAD_LEAK,
+            FIELD_GROUP_CAMERA_HEAD,
+            FIELD_TYPE_BOOL,
+            1,
+            {"cameraHead", "leak"}},
+        DEEP_TREKKER_MOTOR_DIAGNOSTICS(STATE_FIELD_CAMERA_HEAD_TILT_MOTOR,
+            FIELD_GROUP_CAMERA_HEAD,
+            FIELD_GROUP_CAMERA_HEAD,
+            "cameraHead",
+            "tiltMotorDiagnostics"),
+
+        DEEP_TREKKER_MOTOR_DIAGNOSTICS(STATE_FIELD_GRABBER_OPEN_CLOSE_MOTOR,
+            FIELD_GROUP_GRABBER,
+            FIELD_GROUP_GRABBER,
+            "grabber",
+            "openCloseMotorDiagnostics"),
+        DEEP_TREKKER_MOTOR_DIAGNOSTICS(STATE_FIELD_GRABBER_ROTATE_MOTOR,
+            FIELD_GROUP_GRABBER,
+            FIELD_GROUP_GRABBER,
+            "grabber",
+            "rotateMotorDiagnostics"),
+
+        {STATE_FIELD_AUX_LIGHT,
+            FIELD_GROUP_AUX_LIGHT,
+            FIELD_TYPE_NUMBER,
+            field_scales::PERCENT,
+            {"auxLight", "intensity"}},
+        {STATE_FIELD_USAGE_TIME,
+            FIELD_GROUP_USAGE_TIME,
+            FIELD_TYPE_NUMBER,
+            1,
+            {"usageTime", "currentSeconds"}},
+        {STATE_FIELD_CPU_TEMPERATURE,
+            FIELD_GROUP_CPU_TEMPERATURE,
+            FIELD_TYPE_NUMBER,
+            1,
+            {"cpuTemp"}},
+        {STATE_FIELD_LEAK, FIELD_GROUP_LEAK, FIELD_TYPE_BOOL, 1, {"leak"}},
+        {STATE_FIELD_AC_CONNECTED,
+            FIELD_GROUP_AC_CONNECTED,
+            FIELD_TYPE_BOOL,
+            1,
+            {"acConnected"}},
+        {STATE_FIELD_ESTOP, FIELD_GROUP_ESTOP, FIELD_TYPE_BOOL, 1, {"eStop"}},
+        {STATE_FIELD_DISTANCE,
+            FIELD_GROUP_DISTANCE,
+            FIELD_TYPE_NUMBER,
+            field_scales::CENTIMETERS,
+            {"distance"}},
+        {STATE_FIELD_BATTERY_1_PERCENT,
+            FIELD_GROUP_BATTERY_1,
+            FIELD_TYPE_NUMBER,
+            field_scales::PERCENT,
+            {"battery1", "percent"}},
+        {STATE_FIELD_BATTERY_1_VOLTAGE,
+            FIELD_GROUP_BATTERY_1,
+            FIELD_TYPE_NUMBER,
+            1,
+            {"battery1", "voltage"}},
+        {STATE_FIELD_BATTERY_2_PERCENT,
+            FIELD_GROUP_BATTERY_2,
+            FIELD_TYPE_NUMBER,
+            field_scales::PERCENT,
+            {"battery2", "percent"}},
+        {STATE_FIELD_BATTERY_2_VOLTAGE,
+            FIELD_GROUP_BATTERY_2,
+            FIELD_TYPE_NUMBER,
+            1,
+            {"battery2", "voltage"}},
+
+        {STATE_FIELD_REEL_MOTOR_1_PWM,
+            FIELD_GROUP_POWERED_REEL_MOTORS,
+            FIELD_TYPE_NUMBER,
+            field_scales::PERCENT,
+            {"motor1Diagnostics", "pwm"}},
+        {STATE_FIELD_REEL_MOTOR_1_CURRENT,
+            FIELD_GROUP_POWERED_REEL_MOTORS,
+            FIELD_TYPE_NUMBER,
+            1,
+            {"motor1Diagnostics", "current"}},
+        {STATE_FIELD_REEL_MOTOR_1_OVERCURRENT,
+            FIELD_GROUP_POWERED_REEL_MOTORS_OVERCURRENT,
+            FIELD_TYPE_BOOL,
+            1,
+            {"motor1Diagnostics", "overcurrent"}},
+        {STATE_FIELD_REEL_MOTOR_2_PWM,
+            FIELD_GROUP_POWERED_REEL_MOTORS,
+            FIELD_TYPE_NUMBER,
+            field_scales::PERCENT,
+            {"motor2Diagnostics", "pwm"}},
+        {STATE_FIELD_REEL_MOTOR_2_CURRENT,
+            FIELD_GROUP_POWERED_REEL_MOTORS,
+            FIELD_TYPE_NUMBER,
+            1,
+            {"motor2Diagnostics", "current"}},
+        {STATE_FIELD_REEL_MOTOR_2_OVERCURRENT,
+            FIELD_GROUP_POWERED_REEL_MOTORS_OVERCURRENT,
+            FIELD_TYPE_BOOL,
+            1,
+            {"motor2Diagnostics", "overcurrent"}}};
+
+#undef DEEP_TREKKER_MOTOR_DIAGNOSTICS
+
+    namespace details {
+        constexpr bool areDescriptorsIndexedByField()
+        {
+            size_t count = sizeof(FIELD_DESCRIPTORS) / sizeof(FIELD_DESCRIPTORS[0]);
+            if (count != STATE_FIELD_COUNT) {
+                return false;
+            }
+            for (size_t i = 0; i < count; ++i) {
+                if (FIELD_DESCRIPTORS[i].field != static_cast<StateField>(i)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+    }
+
+    static_assert(details::areDescriptorsIndexedByField(),
+        "FIELD_DESCRIPTORS must list all StateField values, in order");
+
+    /** Mask of the field groups (FieldGroup) that have at least one field */
+    constexpr uint32_t describedFieldGroups()
+    {
+        uint32_t groups = 0;
+        for (auto const& descriptor : FIELD_DESCRIPTORS) {
+            groups |= descriptor.group;
+        }
+        return groups;
+    }
+
+    /** Number of fields of the given field groups */
+    constexpr size_t fieldCount(uint32_t field_groups)
+    {
+        size_t count = 0;
+        for (auto const& descriptor : FIELD_DESCRIPTORS) {
+            count += (descriptor.group & field_groups) ? 1 : 0;
+        }
+        return count;
+    }
+}
+
+#endif
@@ -0,0 +1,58 @@
+#include "InvocationTracker.hpp"
+
+using namespace std;
+using namespace deep_trekker;
+
+string InvocationTracker::add(OnCompletion callback)
+{
+    lock_guard<mutex> lock(m_mutex);
+    string id = to_string(++m_last_id);
+    m_pending[id] = callback;
+    return id;
+}
+
+bool InvocationTracker::complete(Json::Value const& msg)
+{
+    OnCompletion callback;
+    {
+        lock_guard<mutex> lock(m_mutex);
+        auto it = m_pending.find(msg["invocationId"].asString());
+        if (it == m_pending.end()) {
+            return false;
+        }
+        callback = move(it->second);
+        m_pending.erase(it);
+    }
+
+    if (!callback) {
+        return true;
+    }
+    if (msg.isMember("error")) {
+        callback(Json::Value(), msg["error"].asString());
+    }
+    else {
+        callback(msg["result"], "");
+    }
+    return true;
+}
+
+void InvocationTracker::failAll(string const& error)
+{
+    map<string, OnCompletion> pending;
+    {
+        lock_guard<mutex> lock(m_mutex);
+        pending.swap(m_pending);
+    }
+
+    for (auto const& invocation : pending) {
+        if (invocation.second) {
+            invocation.second(Json::Value(), error);
+        }
+    }
+}
+
+size_t InvocationTracker::getPendingCount() const
+{
+    lock_guard<mutex> lock(m_mutex);
+    return m_pending.size();
+}
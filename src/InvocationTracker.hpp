@@ -0,0 +1,53 @@
+#ifndef _DEEP_TREKKER_INVOCATION_TRACKER_HPP_
+#define _DEEP_TREKKER_INVOCATION_TRACKER_HPP_
+
+#include <functional>
+#include <json/json.h>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace deep_trekker {
+    /** Matches SignalR completion messages with the invocations in flight
+     *
+     * Any number of invocations may be in flight. Each one gets a new ID, and
+     * its callback is called once, when the matching completion arrives or
+     * when failAll is called.
+     *
+     * All methods are thread-safe. Callbacks are called without holding the
+     * internal lock, so they may start new invocations.
+     */
+    class InvocationTracker {
+    public:
+        /** Callback receiving the result of an invocation
+         *
+         * \c error is empty on success, and \c result null on error
+         */
+        typedef std::function<void(Json::Value const& result, std::string const& error)>
+            OnCompletion;
+
+        /** Register a new invocation
+         *
+         * @return the invocation ID, to be set as the message's invocationId
+         */
+        std::string add(OnCompletion callback);
+
+        /** Resolve the invocation matching a completion message (type 3)
+         *
+         * @return false if the message matches no invocation in flight
+         */
+        bool complete(Json::Value const& msg);
+
+        /** Resolve all the invocations in flight with an error */
+        void failAll(std::string const& error);
+
+        size_t getPendingCount() const;
+
+    private:
+        mutable std::mutex m_mutex;
+        uint64_t m_last_id = 0;
+        std::map<std::string, OnCompletion> m_pending;
+    };
+}
+
+#endif
@@ -1,8 +1,11 @@
 #include <base-logging/Logging.hpp>
 #include <deep_trekker/Rusty.hpp>
 #include <deep_trekker/SignalR.hpp>
+#include <future>
 #include <iostream>
+#include <mutex>
 #include <sstream>
+#include <thread>
 
 using namespace deep_trekker;
 using namespace std;
@@ -16,6 +19,15 @@ shared_ptr<SignalR> createSignalR(shared_ptr<Rusty> rusty,
     string const& rock_peer_id,
     string const& deep_trekker_peer_id);
 
+/** The connections whose metrics are logged, see startMetricsLogging */
+struct MetricsSources {
+    mutex lock;
+    shared_ptr<Rusty> rusty;
+    shared_ptr<SignalR> signalr;
+};
+
+void startMetricsLogging(MetricsSources& sources, base::Time const& period);
+
 int main(int argc, char** argv)
 {
     if (argc != 5) {
@@ -36,8 +48,20 @@ int main(int argc, char** argv)
         rtcInitLogger(rtcLogLevelFromString(env), nullptr);
     }
 
+    // DEEP_TREKKER_METRICS_PERIOD is the period, in seconds, at which the
+    // websocket metrics are logged
+    MetricsSources metrics_sources;
+    auto metrics_period_c = getenv("DEEP_TREKKER_METRICS_PERIOD");
+    if (metrics_period_c) {
+        startMetricsLogging(metrics_sources,
+            base::Time::fromSeconds(atof(metrics_period_c)));
+    }
+
     rtc::WebSocket::Configuration rusty_config;
 
+    // Leaving the previous SignalR session and closing its websocket is done in
+    // the background, while the connection to rusty is reestablished
+    future<void> signalr_teardown;
     while (true) {
         std::shared_ptr<Rusty> rusty = make_shared<Rusty>(rusty_config,
             rusty_host,
@@ -45,13 +69,22 @@ int main(int argc, char** argv)
             deep_trekker_peer_id,
             base::Time::fromSeconds(2),
             base::Time());
+        rusty->enableAutoReconnect();
 
         rusty->waitClientNew();
+        if (signalr_teardown.valid()) {
+            signalr_teardown.get();
+        }
 
         LOG_INFO_S << "Opening connection to Deep Trekker";
         std::shared_ptr<SignalR> signalr =
             createSignalR(rusty, signalr_host, rock_peer_id, deep_trekker_peer_id);
         signalr->setListener(rusty);
+        {
+            lock_guard<mutex> lock(metrics_sources.lock);
+            metrics_sources.rusty = rusty;
+            metrics_sources.signalr = signalr;
+        }
         if (rusty->setClient(signalr)) {
             LOG_INFO_S << "Starting negotiation";
             signalr->start();
@@ -59,8 +92,14 @@ int main(int argc, char** argv)
         }
 
         rusty->waitClientEnd();
+        {
+            lock_guard<mutex> lock(metrics_sources.lock);
+            metrics_sources.rusty.reset();
+            metrics_sources.signalr.reset();
+        }
         rusty.reset();
-        signalr.reset();
+        signalr_teardown = async(launch::async,
+            [signalr = move(signalr)]() mutable { signalr.reset(); });
         LOG_INFO_S << "Rusty client end, waiting for new client";
     }
 }
@@ -102,3 +141,32 @@ std::shared_ptr<SignalR> createSignalR(shared_ptr<Rusty> rusty,
     signalr->setListener(rusty);
     return signalr;
 }
+
+void startMetricsLogging(MetricsSources& sources, base::Time const& period)
+{
+    if (period <= base::Time()) {
+        return;
+    }
+
+    thread([&sources, period] {
+        while (true) {
+            this_thread::sleep_for(chrono::microseconds(period.toMicroseconds()));
+
+            shared_ptr<Rusty> rusty;
+            shared_ptr<SignalR> signalr;
+            {
+                lock_guard<mutex> lock(sources.lock);
+                rusty = sources.rusty;
+                signalr = sources.signalr;
+            }
+            if (rusty) {
+                LOG_INFO_S << "rusty websocket: "
+                           << rusty->getWebSocketMetrics().toString();
+            }
+            if (signalr) {
+                LOG_INFO_S << "signalr websocket: "
+                           << signalr->getWebSocketMetrics().toString();
+            }
+        }
+    }).detach();
+}
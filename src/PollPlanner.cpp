@@ -0,0 +1,120 @@
+#include "PollPlanner.hpp"
+#include "StreamingStateDecoder.hpp"
+#include <algorithm>
+#include <json/json.h>
+
+using namespace std;
+using namespace base;
+using namespace deep_trekker;
+
+PollPlanner::PollPlanner(string const& api_version)
+    : m_api_version(api_version)
+{
+}
+
+size_t PollPlanner::deviceIndex(string const& address)
+{
+    auto it = find(m_devices.begin(), m_devices.end(), address);
+    if (it != m_devices.end()) {
+        return it - m_devices.begin();
+    }
+
+    m_devices.push_back(address);
+    m_on_demand.push_back(0);
+    m_due.push_back(0);
+    return m_devices.size() - 1;
+}
+
+void PollPlanner::setPollPeriod(string const& address,
+    uint32_t field_groups,
+    Time const& period)
+{
+    size_t device = deviceIndex(address);
+    for (auto& schedule : m_schedules) {
+        if (schedule.device == device) {
+            schedule.field_groups &= ~field_groups;
+        }
+    }
+    m_schedules.erase(remove_if(m_schedules.begin(),
+                          m_schedules.end(),
+                          [](Schedule const& s) { return s.field_groups == 0; }),
+        m_schedules.end());
+
+    if (!period.isNull()) {
+        m_schedules.push_back(Schedule{device, field_groups, period, Time()});
+    }
+}
+
+void PollPlanner::requestOnce(string const& address, uint32_t field_groups)
+{
+    m_on_demand[deviceIndex(address)] |= field_groups;
+}
+
+string const& PollPlanner::tick(Time const& now)
+{
+    static const string nothing_due;
+
+    fill(m_due.begin(), m_due.end(), 0);
+    bool any_due = false;
+    for (auto& schedule : m_schedules) {
+        if (!schedule.next.isNull() && now < schedule.next) {
+            continue;
+        }
+
+        m_due[schedule.device] |= schedule.field_groups;
+        any_due = true;
+        // Keep the schedule's phase, unless we are late by more than a period
+        schedule.next = schedule.next.isNull() ? now + schedule.period
+                                               : schedule.next + schedule.period;
+        if (schedule.next <= now) {
+            schedule.next = now + schedule.period;
+        }
+    }
+    for (size_t i = 0; i < m_on_demand.size(); ++i) {
+        m_due[i] |= m_on_demand[i];
+        any_due = any_due || m_on_demand[i];
+        m_on_demand[i] = 0;
+    }
+
+    if (!any_due) {
+        m_request = nullptr;
+        return nothing_due;
+    }
+
+    auto it = m_request_cache.find(m_due);
+    if (it == m_request_cache.end()) {
+        it = m_request_cache.emplace(m_due, renderRequest(m_due)).first;
+    }
+    m_request = &it->second;
+    return *m_request;
+}
+
+string PollPlanner::renderRequest(vector<uint32_t> const& due) const
+{
+    Json::Value request;
+    request["method"] = "GET";
+    request["apiVersion"] = m_api_version;
+    for (size_t i = 0; i < due.size(); ++i) {
+        if (!due[i]) {
+            continue;
+        }
+
+        auto& device = request["payload"]["devices"][m_devices[i]];
+        StreamingStateDecoder::writeRequestFields(due[i], device);
+        if (due[i] & FIELD_GROUP_CAMERAS) {
+            device["cameras"] = Json::Value(Json::objectValue);
+        }
+    }
+
+    Json::FastWriter writer;
+    return writer.write(request);
+}
+
+uint32_t PollPlanner::getLastRequestedGroups(string const& address) const
+{
+    auto it = find(m_devices.begin(), m_devices.end(), address);
+    if (!m_request || it == m_devices.end()) {
+        return 0;
+    }
+    return m_due[it - m_devices.begin()];
+}
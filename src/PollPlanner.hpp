@@ -0,0 +1,72 @@
+#ifndef _DEEP_TREKKER_POLL_PLANNER_HPP_
+#define _DEEP_TREKKER_POLL_PLANNER_HPP_
+
+#include "base/Time.hpp"
+#include "deep_trekker/DeviceSnapshot.hpp"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace deep_trekker {
+    /** Plans the GET requests needed to poll field groups at different rates
+     *
+     * Each call to tick() returns a single GET request covering all the field
+     * groups of all the devices that are due, each field appearing only once.
+     * The requests are cached per combination of due groups, so that they are
+     * rendered only the first time a given combination is due.
+     *
+     * Cameras (FIELD_GROUP_CAMERAS) are requested with an empty cameras object.
+     * They are meant to be polled on demand with requestOnce() rather than
+     * periodically.
+     */
+    class PollPlanner {
+    public:
+        explicit PollPlanner(std::string const& api_version);
+
+        /** Poll the given field groups of a device at the given period
+         *
+         * A null period stops polling these groups. The groups are due on the
+         * next tick.
+         */
+        void setPollPeriod(std::string const& address,
+            uint32_t field_groups,
+            base::Time const& period);
+
+        /** Request the given field groups of a device once, on the next tick */
+        void requestOnce(std::string const& address, uint32_t field_groups);
+
+        /** The GET request covering all the field groups due at \c now
+         *
+         * @return an empty string if nothing is due. The returned string is
+         *   valid until the next call.
+         */
+        std::string const& tick(base::Time const& now);
+
+        /** The field groups of the device that were part of the last request */
+        uint32_t getLastRequestedGroups(std::string const& address) const;
+
+    private:
+        struct Schedule {
+            size_t device;
+            uint32_t field_groups;
+            base::Time period;
+            base::Time next;
+        };
+
+        std::string m_api_version;
+        std::vector<std::string> m_devices;
+        std::vector<Schedule> m_schedules;
+        std::vector<uint32_t> m_on_demand;
+
+        /** Due groups per device in the last request */
+        std::vector<uint32_t> m_due;
+        std::map<std::vector<uint32_t>, std::string> m_request_cache;
+        std::string const* m_request = nullptr;
+
+        size_t deviceIndex(std::string const& address);
+        std::string renderRequest(std::vector<uint32_t> const& due) const;
+    };
+}
+
+#endif
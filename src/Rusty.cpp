@@ -174,3 +174,13 @@ void Rusty::publishICECandidate(string const& candidate, string const& mid)
     msg["data"] = data;
     m_ws.send(m_ws.jsonToString(msg));
 }
+
+void Rusty::enableAutoReconnect(SynchronousWebSocket::ReconnectPolicy const& policy)
+{
+    m_ws.enableAutoReconnect(policy);
+}
+
+WebSocketMetricsSnapshot Rusty::getWebSocketMetrics() const
+{
+    return m_ws.getMetrics();
+}
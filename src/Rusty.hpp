@@ -50,6 +50,16 @@ namespace deep_trekker {
         void waitClientEnd();
         bool setClient(std::shared_ptr<WebRTCNegotiationInterface> client);
 
+        /** Reconnect to rusty when the connection is lost, instead of
+         * requiring a new Rusty object
+         *
+         * The current client is kept, since rusty relays messages by peer ID
+         */
+        void enableAutoReconnect(SynchronousWebSocket::ReconnectPolicy const& policy =
+                                     SynchronousWebSocket::ReconnectPolicy());
+
+        WebSocketMetricsSnapshot getWebSocketMetrics() const;
+
         void publishICECandidate(std::string const& candidate,
             std::string const& mid) override;
         void publishDescription(std::string const& type, std::string const& sdp) override;
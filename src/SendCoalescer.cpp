@@ -0,0 +1,124 @@
+#include "SendCoalescer.hpp"
+#include <base-logging/Logging.hpp>
+
+using namespace std;
+using namespace base;
+using namespace deep_trekker;
+
+SendCoalescer::SendCoalescer(SendFrame send, Time const& window, size_t max_batch_bytes)
+    : m_send(send)
+    , m_window(window.toMicroseconds())
+    , m_max_batch_bytes(max_batch_bytes)
+{
+    m_batch.reserve(max_batch_bytes);
+    m_thread = thread([this] { flushLoop(); });
+}
+
+SendCoalescer::~SendCoalescer()
+{
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_batch_started.notify_one();
+    m_thread.join();
+}
+
+bool SendCoalescer::isRecord(string const& msg)
+{
+    return !msg.empty() && msg.back() == '\x1e';
+}
+
+void SendCoalescer::send(string const& msg)
+{
+    lock_guard<mutex> lock(m_mutex);
+    if (!isRecord(msg)) {
+        flushLocked();
+        m_send(msg, 1);
+        return;
+    }
+
+    bool started = m_batch.empty();
+    m_batch += msg;
+    m_batch_count++;
+    if (m_batch.size() >= m_max_batch_bytes) {
+        flushLocked();
+    }
+    else if (started) {
+        m_deadline = chrono::steady_clock::now() + m_window;
+        m_batch_started.notify_one();
+    }
+}
+
+void SendCoalescer::sendNow(string const& msg)
+{
+    lock_guard<mutex> lock(m_mutex);
+    if (isRecord(msg)) {
+        m_batch += msg;
+        m_batch_count++;
+        flushLocked();
+    }
+    else {
+        flushLocked();
+        m_send(msg, 1);
+    }
+}
+
+void SendCoalescer::flush()
+{
+    lock_guard<mutex> lock(m_mutex);
+    flushLocked();
+}
+
+size_t SendCoalescer::getPendingCount() const
+{
+    lock_guard<mutex> lock(m_mutex);
+    return m_batch_count;
+}
+
+void SendCoalescer::flushLocked()
+{
+    if (m_batch.empty()) {
+        return;
+    }
+
+    try {
+        m_send(m_batch, m_batch_count);
+    }
+    catch (...) {
+        m_batch.clear();
+        m_batch_count = 0;
+        throw;
+    }
+    m_batch.clear();
+    m_batch_count = 0;
+}
+
+void SendCoalescer::flushInBackground()
+{
+    size_t count = m_batch_count;
+    try {
+        flushLocked();
+    }
+    catch (std::exception& e) {
+        LOG_ERROR_S << "failed to send " << count << " coalesced message(s): "
+                    << e.what();
+    }
+}
+
+void SendCoalescer::flushLoop()
+{
+    unique_lock<mutex> lock(m_mutex);
+    while (!m_quit) {
+        if (m_batch.empty()) {
+            m_batch_started.wait(lock);
+        }
+        else if (chrono::steady_clock::now() >= m_deadline) {
+            flushInBackground();
+        }
+        else {
+            m_batch_started.wait_until(lock, m_deadline);
+        }
+    }
+    flushInBackground();
+}
@@ -0,0 +1,71 @@
+#ifndef _DEEP_TREKKER_SEND_COALESCER_HPP_
+#define _DEEP_TREKKER_SEND_COALESCER_HPP_
+
+#include <base/Time.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace deep_trekker {
+    /** Joins the messages sent within a short window into a single frame
+     *
+     * Only the messages that are complete \x1e-terminated records, as in
+     * SignalR, can share a frame. Any other message is sent in its own frame,
+     * after the pending batch so that the order is kept.
+     *
+     * A batch is sent when the window that started with its first message
+     * elapses, when it reaches the maximum batch size, or on flush or sendNow.
+     * With a zero window, the batch is sent as soon as the background thread
+     * wakes up, which joins the messages of a burst sent back to back.
+     *
+     * A batch whose send fails is dropped. The error is thrown by the call that
+     * triggered the send, or logged if it was the background thread.
+     */
+    class SendCoalescer {
+    public:
+        /** Function called to send a frame, made of \c message_count messages */
+        typedef std::function<void(std::string const& frame, size_t message_count)>
+            SendFrame;
+
+        SendCoalescer(SendFrame send,
+            base::Time const& window,
+            size_t max_batch_bytes = 65536);
+        /** Sends the pending batch */
+        ~SendCoalescer();
+
+        /** Queue a message, or send it right away if it cannot be joined */
+        void send(std::string const& msg);
+        /** Send a latency-critical message, along with the pending batch */
+        void sendNow(std::string const& msg);
+        /** Send the pending batch */
+        void flush();
+
+        size_t getPendingCount() const;
+
+        /** Whether \c msg is a complete record, that can share a frame */
+        static bool isRecord(std::string const& msg);
+
+    private:
+        SendFrame m_send;
+        std::chrono::microseconds m_window;
+        size_t m_max_batch_bytes;
+
+        mutable std::mutex m_mutex;
+        std::condition_variable m_batch_started;
+        std::string m_batch;
+        size_t m_batch_count = 0;
+        std::chrono::steady_clock::time_point m_deadline;
+        bool m_quit = false;
+        std::thread m_thread;
+
+        void flushLocked();
+        /** flushLocked for the background thread, which logs send errors */
+        void flushInBackground();
+        void flushLoop();
+    };
+}
+
+#endif
@@ -91,7 +91,10 @@ void SignalR::open()
         setState(STATE_JSON_ERROR);
     });
 
-    m_ws.onWebSocketError([&](string const& error) { setState(STATE_CONNECTION_LOST); });
+    m_ws.onWebSocketError([&](string const& error) {
+        m_invocations.failAll("connection lost: " + error);
+        setState(STATE_CONNECTION_LOST);
+    });
 }
 
 void SignalR::start()
@@ -166,21 +169,24 @@ void SignalR::process(Json::Value const& msg)
         return;
     }
 
+    int type = msg["type"].asInt();
+    if (type == 3) {
+        processReply(msg);
+        return;
+    }
+
     auto listener = m_listener.lock();
     if (!listener) {
         return;
     }
 
-    int type = msg["type"].asInt();
     if (type == 6) {
         listener->pong();
     }
-    else if (type == 3) {
-        processReply(msg);
-    }
     else if (type == 1 && msg["target"].asString() == "session_list") {
         m_session_id = msg["arguments"][0][0]["session_id"].asString();
         LOG_INFO_S << "signalr: session ID is " << m_session_id;
+        sessionJoinIfReady();
     }
     else if (type == 1 && msg["target"].asString() == "session_info") {
         bool found = false;
@@ -213,94 +219,34 @@ void SignalR::process(Json::Value const& msg)
         listener->publishICECandidate(data["candidate"]["content"].asString(),
             data["candidate"]["sdpMid"].asString());
     }
-
-    switch (m_state) {
-        case STATE_SESSION_CHECK: {
-            if (!hasReceivedReply()) {
-                LOG_DEBUG_S << "signalr: waiting for session check reply";
-                return;
-            }
-            if (m_session_id.empty()) {
-                LOG_DEBUG_S << "signalr: waiting for session ID";
-                return;
-            }
-
-            sessionJoin();
-            break;
-        }
-
-        case STATE_SESSION_JOIN: {
-            if (!hasReceivedReply()) {
-                return;
-            }
-
-            setState(STATE_READY);
-            break;
-        }
-
-        default:
-            break;
-    }
 }
 
-string SignalR::getNextInvocationID()
+void SignalR::call(string const& target,
+    Json::Value const& arg,
+    InvocationTracker::OnCompletion callback)
 {
-    if (m_last_used_invocation_id != m_last_received_invocation_id) {
-        throw runtime_error(
-            "attempting to perform a call before the previous one was resolved");
+    if (!callback) {
+        callback = [target](Json::Value const&, string const& error) {
+            if (!error.empty()) {
+                LOG_ERROR_S << "signalr: " << target << " failed: " << error;
+            }
+        };
     }
-    return to_string(++m_last_used_invocation_id);
-}
 
-void SignalR::call(string const& target, Json::Value const& arg)
-{
     Json::Value message;
     message["arguments"].append(m_ws.jsonToString(arg));
     message["target"] = target;
     message["type"] = 1;
-    if (!hasReceivedReply()) {
-        m_message_queue.push(message);
-    }
-    else {
-        invoke(message);
-    }
-}
-
-void SignalR::invoke(Json::Value message)
-{
-
-    message["invocationId"] = getNextInvocationID();
-    auto msg = m_ws.jsonToString(message);
-    m_ws.send(msg + "\x1e");
-}
-
-bool SignalR::hasReceivedReply() const
-{
-    return m_last_received_invocation_id == m_last_used_invocation_id;
+    message["invocationId"] = m_invocations.add(callback);
+    m_ws.send(m_ws.jsonToString(message) + "\x1e");
 }
 
-Json::Value SignalR::processReply(Json::Value const& ret)
+void SignalR::processReply(Json::Value const& reply)
 {
-    if (ret["invocationId"].asString() != to_string(m_last_used_invocation_id)) {
-        throw runtime_error("expected to receive result for call ID " +
-                            to_string(m_last_used_invocation_id) + " but is " +
-                            to_string(m_last_received_invocation_id));
-    }
-
-    m_last_received_invocation_id = m_last_used_invocation_id;
-    if (!m_message_queue.empty()) {
-        auto json = m_message_queue.front();
-        m_message_queue.pop();
-        invoke(json);
+    if (!m_invocations.complete(reply)) {
+        LOG_ERROR_S << "signalr: received completion for unknown invocation "
+                    << reply["invocationId"].asString();
     }
-
-    if (ret.isMember("error")) {
-        throw runtime_error("received error in reply to call " +
-                            to_string(m_last_used_invocation_id) + ": " +
-                            ret["error"].asString());
-    }
-
-    return ret["result"];
 }
 
 void SignalR::handshake()
@@ -318,7 +264,32 @@ void SignalR::sessionCheck()
     args["client_id"] = m_rock_peer_id;
     m_state = STATE_SESSION_CHECK;
     LOG_INFO_S << "signalr: session check";
-    call("session_check", args);
+    call("session_check", args, [this](Json::Value const&, string const& error) {
+        if (!error.empty()) {
+            LOG_ERROR_S << "signalr: session check failed: " << error;
+            setState(STATE_PROTOCOL_ERROR);
+            return;
+        }
+        m_session_checked = true;
+        sessionJoinIfReady();
+    });
+}
+
+void SignalR::sessionJoinIfReady()
+{
+    if (m_state != STATE_SESSION_CHECK) {
+        return;
+    }
+    if (!m_session_checked) {
+        LOG_DEBUG_S << "signalr: waiting for session check reply";
+        return;
+    }
+    if (m_session_id.empty()) {
+        LOG_DEBUG_S << "signalr: waiting for session ID";
+        return;
+    }
+
+    sessionJoin();
 }
 
 void SignalR::sessionJoin()
@@ -332,7 +303,14 @@ void SignalR::sessionJoin()
     args["session_id"] = m_session_id;
     m_state = STATE_SESSION_JOIN;
     LOG_INFO_S << "signalr: starting session join";
-    call("join_session", args);
+    call("join_session", args, [this](Json::Value const&, string const& error) {
+        if (!error.empty()) {
+            LOG_ERROR_S << "signalr: session join failed: " << error;
+            setState(STATE_PROTOCOL_ERROR);
+            return;
+        }
+        setState(STATE_READY);
+    });
 }
 
 void SignalR::sessionLeave()
@@ -386,4 +364,9 @@ void SignalR::pong()
 void SignalR::setListener(shared_ptr<WebRTCNegotiationInterface> listener)
 {
     m_listener = listener;
-}
\ No newline at end of file
+}
+
+WebSocketMetricsSnapshot SignalR::getWebSocketMetrics() const
+{
+    return m_ws.getMetrics();
+}
@@ -2,11 +2,11 @@
 #define DEEP_TREKKER_SIGNALR_HPP
 
 #include <memory>
-#include <queue>
 
 #include <json/json.h>
 #include <rtc/rtc.hpp>
 
+#include <deep_trekker/InvocationTracker.hpp>
 #include <deep_trekker/NullWebRTCNegotiation.hpp>
 #include <deep_trekker/SynchronousWebSocket.hpp>
 #include <deep_trekker/WebRTCNegotiationInterface.hpp>
@@ -47,18 +47,22 @@ namespace deep_trekker {
         template <typename Lock>
         void waitState(States state, Lock& lock, base::Time const& timeout);
 
-        int m_last_used_invocation_id = 0;
-        int m_last_received_invocation_id = 0;
+        InvocationTracker m_invocations;
+        bool m_session_checked = false;
         std::string m_session_id;
-        std::queue<Json::Value> m_message_queue;
         Json::Value m_signalr_context;
 
-        std::string getNextInvocationID();
-
-        void call(std::string const& target, Json::Value const& arg);
-        void invoke(Json::Value message);
-        bool hasReceivedReply() const;
-        Json::Value processReply(Json::Value const& ret);
+        /** Invoke a hub method, without waiting for the previous invocations
+         *
+         * The server runs the invocations of a connection in order. \c callback
+         * is called from the network thread with the invocation's result. If
+         * it is not set, errors are logged.
+         */
+        void call(std::string const& target,
+            Json::Value const& arg,
+            InvocationTracker::OnCompletion callback = InvocationTracker::OnCompletion());
+        void processReply(Json::Value const& reply);
+        void sessionJoinIfReady();
 
         std::weak_ptr<WebRTCNegotiationInterface> m_listener =
             NullWebRTCNegotiation::instance();
@@ -102,6 +106,8 @@ namespace deep_trekker {
         void start();
         void setListener(std::shared_ptr<WebRTCNegotiationInterface> listener);
 
+        WebSocketMetricsSnapshot getWebSocketMetrics() const;
+
         void waitState(States state,
             base::Time const& timeout = base::Time::fromSeconds(1));
         void waitState(States state,
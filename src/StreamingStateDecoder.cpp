@@ -0,0 +1,613 @@
+#include "StreamingStateDecoder.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+using namespace base;
+using namespace base::samples;
+using namespace power_base;
+using namespace deep_trekker;
+
+namespace {
+    typedef bitset<STATE_FIELD_COUNT> FieldMask;
+
+    /** The mask of the fields that are required for each field group, indexed by
+     * the group's bit number
+     */
+    array<FieldMask, 32> const& groupMasks()
+    {
+        static array<FieldMask, 32> masks = [] {
+            array<FieldMask, 32> result;
+            for (auto const& entry : FIELD_DESCRIPTORS) {
+                for (int bit = 0; bit < 32; ++bit) {
+                    if (entry.group == (1u << bit)) {
+                        result[bit].set(entry.field);
+                    }
+                }
+            }
+            return result;
+        }();
+        return masks;
+    }
+
+    /** The value of a field, converted by its descriptor's scale */
+    double scaled(RawDeviceStates const& raw, int field)
+    {
+        return raw.values[field] * FIELD_DESCRIPTORS[field].scale;
+    }
+
+    JointState motorJointState(RawDeviceStates const& raw, int pwm_field)
+    {
+        JointState joint_state;
+        joint_state.raw = scaled(raw, pwm_field);
+        joint_state.effort = scaled(raw, pwm_field + 1);
+        joint_state.speed = scaled(raw, pwm_field + 2);
+        return joint_state;
+    }
+
+    void toBattery(RawDeviceStates const& raw,
+        int percent_field,
+        Time const& time,
+        BatteryStatus& battery)
+    {
+        battery.time = time;
+        battery.charge = scaled(raw, percent_field);
+        battery.voltage = scaled(raw, percent_field + 1);
+    }
+}
+
+bool StreamingStateDecoder::decode(char const* begin,
+    char const* end,
+    ResolveDevice const& resolve,
+    string& errors)
+{
+    m_cursor = begin;
+    m_end = end;
+    m_resolve = &resolve;
+    m_device = nullptr;
+    m_path.fill(string_view());
+    m_method.clear();
+
+    skipWhitespace();
+    bool result = parseValue(0);
+    if (result) {
+        skipWhitespace();
+        if (m_cursor != m_end) {
+            result = fail("extra characters after the end of the message");
+        }
+    }
+
+    if (!result) {
+        errors = m_error;
+    }
+    m_resolve = nullptr;
+    m_device = nullptr;
+    return result;
+}
+
+string const& StreamingStateDecoder::getMethod() const
+{
+    return m_method;
+}
+
+bool StreamingStateDecoder::fail(string const& message)
+{
+    m_error = message;
+    return false;
+}
+
+void StreamingStateDecoder::skipWhitespace()
+{
+    while (m_cursor != m_end &&
+           (*m_cursor == ' ' || *m_cursor == '\n' || *m_cursor == '\r' ||
+               *m_cursor == '\t')) {
+        ++m_cursor;
+    }
+}
+
+bool StreamingStateDecoder::parseValue(int depth)
+{
+    if (depth > 256) {
+        return fail("maximum nesting depth exceeded");
+    }
+    if (m_cursor == m_end) {
+        return fail("unexpected end of message");
+    }
+
+    switch (*m_cursor) {
+        case '{':
+            return parseObject(depth);
+        case '[':
+            return parseArray(depth);
+        case '"': {
+            string_view str;
+            if (!parseString(str)) {
+                return false;
+            }
+            if (depth == 1 && m_path[0] == "method") {
+                m_method = str;
+            }
+            return true;
+        }
+        case 't':
+            if (!parseLiteral("true", 4)) {
+                return false;
+            }
+            storeValue(depth, 1);
+            return true;
+        case 'f':
+            if (!parseLiteral("false", 5)) {
+                return false;
+            }
+            storeValue(depth, 0);
+            return true;
+        case 'n':
+            return parseLiteral("null", 4);
+        default: {
+            double value;
+            if (!parseNumber(value)) {
+                return false;
+            }
+            storeValue(depth, value);
+            return true;
+        }
+    }
+}
+
+bool StreamingStateDecoder::parseObject(int depth)
+{
+    ++m_cursor;
+
+    bool is_device = depth == 3 && m_path[0] == "payload" && m_path[1] == "devices" &&
+                     m_path[2].data() != nullptr;
+    if (is_device) {
+        m_device = (*m_resolve)(m_path[2]);
+    }
+
+    skipWhitespace();
+    if (m_cursor != m_end && *m_cursor == '}') {
+        ++m_cursor;
+    }
+    else {
+        while (true) {
+            skipWhitespace();
+            string_view key;
+            if (m_cursor == m_end || *m_cursor != '"') {
+                return fail("expected a field name");
+            }
+            if (!parseString(key)) {
+                return false;
+            }
+            skipWhitespace();
+            if (m_cursor == m_end || *m_cursor != ':') {
+                return fail("expected ':' after a field name");
+            }
+            ++m_cursor;
+            skipWhitespace();
+
+            if (depth < MAX_PATH_DEPTH) {
+                m_path[depth] = key;
+            }
+            if (!parseValue(depth + 1)) {
+                return false;
+            }
+
+            skipWhitespace();
+            if (m_cursor == m_end) {
+                return fail("unexpected end of message in object");
+            }
+            else if (*m_cursor == ',') {
+                ++m_cursor;
+            }
+            else if (*m_cursor == '}') {
+                ++m_cursor;
+                break;
+            }
+            else {
+                return fail("expected ',' or '}' in object");
+            }
+        }
+    }
+
+    if (depth < MAX_PATH_DEPTH) {
+        m_path[depth] = string_view();
+    }
+    if (is_device) {
+        m_device = nullptr;
+    }
+    return true;
+}
+
+bool StreamingStateDecoder::parseArray(int depth)
+{
+    ++m_cursor;
+    if (depth < MAX_PATH_DEPTH) {
+        m_path[depth] = string_view();
+    }
+
+    skipWhitespace();
+    if (m_cursor != m_end && *m_cursor == ']') {
+        ++m_cursor;
+        return true;
+    }
+
+    while (true) {
+        skipWhitespace();
+        if (!parseValue(depth + 1)) {
+            return false;
+        }
+        skipWhitespace();
+        if (m_cursor == m_end) {
+            return fail("unexpected end of message in array");
+        }
+        else if (*m_cursor == ',') {
+            ++m_cursor;
+        }
+        else if (*m_cursor == ']') {
+            ++m_cursor;
+            return true;
+        }
+        else {
+            return fail("expected ',' or ']' in array");
+        }
+    }
+}
+
+bool StreamingStateDecoder::parseString(string_view& str)
+{
+    char const* start = ++m_cursor;
+    while (m_cursor != m_end && *m_cursor != '"') {
+        if (*m_cursor == '\\') {
+            ++m_cursor;
+            if (m_cursor == m_end) {
+                break;
+            }
+        }
+        ++m_cursor;
+    }
+    if (m_cursor == m_end) {
+        return fail("unterminated string");
+    }
+
+    str = string_view(start, m_cursor - start);
+    ++m_cursor;
+    return true;
+}
+
+bool StreamingStateDecoder::parseNumber(double& value)
+{
+    char const* start = m_cursor;
+    while (m_cursor != m_end && (isdigit(*m_cursor) || *m_cursor == '-' ||
+                                    *m_cursor == '+' || *m_cursor == '.' ||
+                                    *m_cursor == 'e' || *m_cursor == 'E')) {
+        ++m_cursor;
+    }
+
+    // Copy the number, as the message is not guaranteed to be NUL-terminated
+    char buffer[64];
+    size_t length = m_cursor - start;
+    if (length == 0 || length >= sizeof(buffer)) {
+        return fail("invalid number");
+    }
+    memcpy(buffer, start, length);
+    buffer[length] = '\0';
+
+    char* number_end;
+    value = strtod(buffer, &number_end);
+    if (number_end != buffer + length) {
+        return fail("invalid number");
+    }
+    return true;
+}
+
+bool StreamingStateDecoder::parseLiteral(char const* literal, size_t length)
+{
+    if (static_cast<size_t>(m_end - m_cursor) < length ||
+        strncmp(m_cursor, literal, length) != 0) {
+        return fail("invalid literal");
+    }
+    m_cursor += length;
+    return true;
+}
+
+void StreamingStateDecoder::storeValue(int depth, double value)
+{
+    int length = depth - 3;
+    if (!m_device || length < 1 || length > 3) {
+        return;
+    }
+
+    for (auto const& entry : FIELD_DESCRIPTORS) {
+        bool match = true;
+        for (int i = 0; match && i < 3; ++i) {
+            bool in_entry = entry.path[i].data() != nullptr;
+            if (in_entry != (i < length)) {
+                match = false;
+            }
+            else if (in_entry) {
+                match = (entry.path[i] == m_path[3 + i]);
+            }
+        }
+        if (match) {
+            m_device->values[entry.field] = value;
+            m_device->present.set(entry.field);
+            return;
+        }
+    }
+}
+
+void StreamingStateDecoder::fromJson(Json::Value const& device, RawDeviceStates& raw)
+{
+    for (auto const& entry : FIELD_DESCRIPTORS) {
+        Json::Value const* value = &device;
+        for (int i = 0; i < 3 && entry.path[i].data() && value; ++i) {
+            auto const& name = entry.path[i];
+            value = value->isObject()
+                        ? value->find(name.data(), name.data() + name.size())
+                        : nullptr;
+        }
+
+        if (!value) {
+            continue;
+        }
+        else if (value->isBool()) {
+            raw.values[entry.field] = value->asBool() ? 1 : 0;
+        }
+        else if (value->isNumeric()) {
+            raw.values[entry.field] = value->asDouble();
+        }
+        else {
+            continue;
+        }
+        raw.present.set(entry.field);
+    }
+}
+
+uint32_t StreamingStateDecoder::merge(RawDeviceStates const& update,
+    RawDeviceStates& state)
+{
+    uint32_t changed = 0;
+    for (auto const& entry : FIELD_DESCRIPTORS) {
+        if (!update.present[entry.field]) {
+            continue;
+        }
+
+        double value = update.values[entry.field];
+        if (!state.present[entry.field] || state.values[entry.field] != value) {
+            state.values[entry.field] = value;
+            state.present.set(entry.field);
+            changed |= entry.group;
+        }
+    }
+    return changed;
+}
+
+void StreamingStateDecoder::writeRequestFields(uint32_t field_groups,
+    Json::Value& device)
+{
+    for (auto const& entry : FIELD_DESCRIPTORS) {
+        if (!(field_groups & entry.group)) {
+            continue;
+        }
+
+        Json::Value* value = &device;
+        for (int i = 0; i < 3 && entry.path[i].data(); ++i) {
+            value = &(*value)[string(entry.path[i])];
+        }
+        if (entry.type == FIELD_TYPE_BOOL) {
+            *value = false;
+        }
+        else {
+            *value = 0;
+        }
+    }
+}
+
+bitset<STATE_FIELD_COUNT> StreamingStateDecoder::missingFields(
+    RawDeviceStates const& raw,
+    uint32_t field_groups)
+{
+    FieldMask missing;
+    for (auto const& entry : FIELD_DESCRIPTORS) {
+        if ((field_groups & entry.group) && !raw.present[entry.field]) {
+            missing.set(entry.field);
+        }
+    }
+    return missing;
+}
+
+string StreamingStateDecoder::describeFields(bitset<STATE_FIELD_COUNT> const& fields)
+{
+    string result;
+    for (auto const& entry : FIELD_DESCRIPTORS) {
+        if (!fields[entry.field]) {
+            continue;
+        }
+
+        if (!result.empty()) {
+            result += ", ";
+        }
+        for (int i = 0; i < 3 && entry.path[i].data(); ++i) {
+            if (i != 0) {
+                result += ".";
+            }
+            result += entry.path[i];
+        }
+    }
+    return result;
+}
+
+void StreamingStateDecoder::toSnapshot(RawDeviceStates const& raw,
+    Time const& time,
+    DeviceSnapshot& snapshot)
+{
+    snapshot.time = time;
+    snapshot.field_groups = 0;
+    auto const& masks = groupMasks();
+    for (int bit = 0; bit < 32; ++bit) {
+        if (masks[bit].any() && (raw.present & masks[bit]) == masks[bit]) {
+            snapshot.field_groups |= (1u << bit);
+        }
+    }
+
+    auto const& v = raw.values;
+    auto& revolution = snapshot.revolution;
+    auto& powered_reel = snapshot.powered_reel;
+    auto& manual_reel = snapshot.manual_reel;
+    revolution.time = snapshot.time;
+    powered_reel.time = snapshot.time;
+    manual_reel.time = snapshot.time;
+
+    if (snapshot.has(FIELD_GROUP_MODEL)) {
+        snapshot.model = static_cast<int>(v[STATE_FIELD_MODEL]);
+    }
+
+    if (snapshot.has(FIELD_GROUP_POSE)) {
+        double roll = scaled(raw, STATE_FIELD_ROLL);
+        double pitch = scaled(raw, STATE_FIELD_PITCH);
+        double yaw = scaled(raw, STATE_FIELD_HEADING);
+
+        auto& pose = revolution.pose;
+        pose.time = snapshot.time;
+        pose.position.z() = scaled(raw, STATE_FIELD_DEPTH);
+        pose.cov_position(2, 2) = 1e-1;
+        pose.orientation = AngleAxisd(yaw, Vector3d::UnitZ()) *
+                           AngleAxisd(pitch, Vector3d::UnitY()) *
+                           AngleAxisd(roll, Vector3d::UnitX());
+        // 1 degree squared in radians
+        pose.cov_orientation = Matrix3d::Identity() * pow(0.0174533, 2);
+    }
+
+    if (snapshot.has(FIELD_GROUP_DRIVE_THRUST)) {
+        auto& control = revolution.drive_setpoint;
+        control.time = snapshot.time;
+        control.position.x() = scaled(raw, STATE_FIELD_THRUST_FORWARD);
+        control.position.y() = scaled(raw, STATE_FIELD_THRUST_LATERAL);
+        control.position.z() = scaled(raw, STATE_FIELD_THRUST_VERTICAL);
+        control.orientation = Quaterniond(
+            AngleAxisd(scaled(raw, STATE_FIELD_THRUST_YAW), Vector3d::UnitZ()));
+    }
+
+    if (snapshot.has(FIELD_GROUP_DRIVE_MODES)) {
+        revolution.drive_modes.time = snapshot.time;
+        revolution.drive_modes.heading_lock = v[STATE_FIELD_MODE_HEADING_LOCK] != 0;
+        revolution.drive_modes.depth_lock = v[STATE_FIELD_MODE_DEPTH_LOCK] != 0;
+        revolution.drive_modes.altitude_lock = v[STATE_FIELD_MODE_ALTITUDE_LOCK] != 0;
+        revolution.motors_disabled = v[STATE_FIELD_MODE_MOTORS_DISABLED] != 0;
+        revolution.auto_stabilization = v[STATE_FIELD_MODE_AUTO_STABILIZATION] != 0;
+    }
+
+    if (snapshot.has(FIELD_GROUP_REVOLUTION_MOTORS)) {
+        revolution.motor_states.time = snapshot.time;
+        revolution.motor_states.elements.resize(6);
+        for (int i = 0; i < 6; ++i) {
+            revolution.motor_states.elements[i] =
+                motorJointState(raw, STATE_FIELD_FRONT_RIGHT_MOTOR_PWM + 4 * i);
+        }
+    }
+
+    if (snapshot.has(FIELD_GROUP_REVOLUTION_MOTORS_OVERCURRENT)) {
+        revolution.front_right_motor_overcurrent =
+            v[STATE_FIELD_FRONT_RIGHT_MOTOR_OVERCURRENT] != 0;
+        revolution.front_left_motor_overcurrent =
+            v[STATE_FIELD_FRONT_LEFT_MOTOR_OVERCURRENT] != 0;
+        revolution.rear_right_motor_overcurrent =
+            v[STATE_FIELD_REAR_RIGHT_MOTOR_OVERCURRENT] != 0;
+        revolution.rear_left_motor_overcurrent =
+            v[STATE_FIELD_REAR_LEFT_MOTOR_OVERCURRENT] != 0;
+        revolution.vertical_right_motor_overcurrent =
+            v[STATE_FIELD_VERTICAL_RIGHT_MOTOR_OVERCURRENT] != 0;
+        revolution.vertical_left_motor_overcurrent =
+            v[STATE_FIELD_VERTICAL_LEFT_MOTOR_OVERCURRENT] != 0;
+    }
+
+    if (snapshot.has(FIELD_GROUP_CAMERA_HEAD)) {
+        auto& camera_head = revolution.camera_head;
+        camera_head.time = snapshot.time;
+        camera_head.light = scaled(raw, STATE_FIELD_CAMERA_HEAD_LIGHT);
+        camera_head.laser = v[STATE_FIELD_CAMERA_HEAD_LASERS] != 0;
+        camera_head.motor_overcurrent =
+            v[STATE_FIELD_CAMERA_HEAD_TILT_MOTOR_OVERCURRENT] != 0;
+        camera_head.leak = v[STATE_FIELD_CAMERA_HEAD_LEAK] != 0;
+
+        JointState joint_state =
+            motorJointState(raw, STATE_FIELD_CAMERA_HEAD_TILT_MOTOR_PWM);
+        if (snapshot.has(FIELD_GROUP_POSE)) {
+            double tilt = scaled(raw, STATE_FIELD_CAMERA_HEAD_TILT) -
+                          scaled(raw, STATE_FIELD_PITCH);
+            joint_state.position = Angle::fromRad(tilt).getRad();
+        }
+        camera_head.motor_states.time = snapshot.time;
+        camera_head.motor_states.elements.resize(1);
+        camera_head.motor_states.elements[0] = joint_state;
+    }
+
+    if (snapshot.has(FIELD_GROUP_GRABBER)) {
+        auto& grabber = revolution.grabber;
+        grabber.motor_states.time = snapshot.time;
+        grabber.motor_states.elements.resize(2);
+        grabber.motor_states.elements[0] =
+            motorJointState(raw, STATE_FIELD_GRABBER_OPEN_CLOSE_MOTOR_PWM);
+        grabber.motor_states.elements[1] =
+            motorJointState(raw, STATE_FIELD_GRABBER_ROTATE_MOTOR_PWM);
+        grabber.open_close_motor_overcurrent =
+            v[STATE_FIELD_GRABBER_OPEN_CLOSE_MOTOR_OVERCURRENT] != 0;
+        grabber.rotate_overcurrent = v[STATE_FIELD_GRABBER_ROTATE_MOTOR_OVERCURRENT] != 0;
+    }
+
+    if (snapshot.has(FIELD_GROUP_POWERED_REEL_MOTORS)) {
+        powered_reel.motor_states.time = snapshot.time;
+        powered_reel.motor_states.elements.resize(2);
+        JointState state;
+        state.raw = scaled(raw, STATE_FIELD_REEL_MOTOR_1_PWM);
+        state.effort = scaled(raw, STATE_FIELD_REEL_MOTOR_1_CURRENT);
+        powered_reel.motor_states.elements[0] = state;
+        state.raw = scaled(raw, STATE_FIELD_REEL_MOTOR_2_PWM);
+        state.effort = scaled(raw, STATE_FIELD_REEL_MOTOR_2_CURRENT);
+        powered_reel.motor_states.elements[1] = state;
+    }
+
+    if (snapshot.has(FIELD_GROUP_POWERED_REEL_MOTORS_OVERCURRENT)) {
+        powered_reel.motor_1_overcurrent = v[STATE_FIELD_REEL_MOTOR_1_OVERCURRENT] != 0;
+        powered_reel.motor_2_overcurrent = v[STATE_FIELD_REEL_MOTOR_2_OVERCURRENT] != 0;
+    }
+
+    if (snapshot.has(FIELD_GROUP_BATTERY_1)) {
+        toBattery(raw,
+            STATE_FIELD_BATTERY_1_PERCENT,
+            snapshot.time,
+            powered_reel.battery_1);
+    }
+    if (snapshot.has(FIELD_GROUP_BATTERY_2)) {
+        toBattery(raw,
+            STATE_FIELD_BATTERY_2_PERCENT,
+            snapshot.time,
+            powered_reel.battery_2);
+    }
+    if (snapshot.has(FIELD_GROUP_AC_CONNECTED)) {
+        powered_reel.ac_power_connected = v[STATE_FIELD_AC_CONNECTED] != 0;
+    }
+    if (snapshot.has(FIELD_GROUP_ESTOP)) {
+        powered_reel.estop_enabled = v[STATE_FIELD_ESTOP] != 0;
+    }
+    if (snapshot.has(FIELD_GROUP_AUX_LIGHT)) {
+        revolution.aux_light = scaled(raw, STATE_FIELD_AUX_LIGHT);
+    }
+    if (snapshot.has(FIELD_GROUP_USAGE_TIME)) {
+        revolution.usage_time = Time::fromSeconds(scaled(raw, STATE_FIELD_USAGE_TIME));
+    }
+    if (snapshot.has(FIELD_GROUP_CPU_TEMPERATURE)) {
+        revolution.cpu_temperature = v[STATE_FIELD_CPU_TEMPERATURE];
+        powered_reel.cpu_temperature = v[STATE_FIELD_CPU_TEMPERATURE];
+        manual_reel.cpu_temperature = v[STATE_FIELD_CPU_TEMPERATURE];
+    }
+    if (snapshot.has(FIELD_GROUP_LEAK)) {
+        powered_reel.leak = v[STATE_FIELD_LEAK] != 0;
+        manual_reel.leak = v[STATE_FIELD_LEAK] != 0;
+    }
+    if (snapshot.has(FIELD_GROUP_DISTANCE)) {
+        powered_reel.tether_length = scaled(raw, STATE_FIELD_DISTANCE);
+        manual_reel.tether_length = scaled(raw, STATE_FIELD_DISTANCE);
+    }
+}
@@ -0,0 +1,128 @@
+#ifndef _DEEP_TREKKER_STREAMING_STATE_DECODER_HPP_
+#define _DEEP_TREKKER_STREAMING_STATE_DECODER_HPP_
+
+#include "deep_trekker/DeviceSnapshot.hpp"
+#include "deep_trekker/FieldDescriptors.hpp"
+#include <array>
+#include <bitset>
+#include <functional>
+#include <json/json.h>
+#include <string>
+#include <string_view>
+
+namespace deep_trekker {
+    /** Raw values of the fields of a device, as found in the message
+     *
+     * Booleans are stored as 0 or 1
+     */
+    struct RawDeviceStates {
+        std::bitset<STATE_FIELD_COUNT> present;
+        std::array<double, STATE_FIELD_COUNT> values;
+    };
+
+    /** Decoder that extracts the device states straight from the message text
+     *
+     * Unlike CommandAndStateMessageParser::parseJSONMessage, it does not build
+     * a JSON tree. It scans the message once, and writes the scalar fields listed
+     * in StateField into fixed-size RawDeviceStates. The cameras are not decoded
+     * by this decoder.
+     */
+    class StreamingStateDecoder {
+    public:
+        /** Function called when the decoder finds a new device in payload/devices
+         *
+         * It returns the structure in which the device fields should be written,
+         * or nullptr if the device should be ignored
+         */
+        typedef std::function<RawDeviceStates*(std::string_view address)>
+            ResolveDevice;
+
+        /** Decode a message
+         *
+         * @return false if the message is not valid JSON, in which case \c errors
+         *   contains a description of the problem. The devices resolved before the
+         *   error was found may have been partially updated
+         */
+        bool decode(char const* begin,
+            char const* end,
+            ResolveDevice const& resolve,
+            std::string& errors);
+
+        /** Convert the raw values of a device into the snapshot
+         *
+         * Only the field groups whose fields are all present are converted and
+         * marked in DeviceSnapshot::field_groups. All the samples are stamped
+         * with \c time
+         */
+        static void toSnapshot(RawDeviceStates const& raw,
+            base::Time const& time,
+            DeviceSnapshot& snapshot);
+
+        /** Extract the StateField values of a device that has already been
+         * parsed into a JSON tree
+         *
+         * The fields present in \c device are set in \c raw, the others are
+         * left untouched
+         */
+        static void fromJson(Json::Value const& device, RawDeviceStates& raw);
+
+        /** Merge the fields present in \c update into \c state
+         *
+         * @return the mask of the field groups (FieldGroup) with at least one
+         *   field that was not present in \c state or whose value changed
+         */
+        static uint32_t merge(RawDeviceStates const& update, RawDeviceStates& state);
+
+        /** Write the fields of the given field groups in the device entry of a GET
+         * request
+         *
+         * Numeric fields are set to 0 and boolean fields to false.
+         * FIELD_GROUP_CAMERAS is not handled, as the cameras are not StateField
+         * values.
+         */
+        static void writeRequestFields(uint32_t field_groups, Json::Value& device);
+
+        /** The fields of the given field groups that are not present in \c raw
+         *
+         * A field group can be decoded if, and only if, none of its fields are
+         * missing
+         */
+        static std::bitset<STATE_FIELD_COUNT> missingFields(RawDeviceStates const& raw,
+            uint32_t field_groups);
+
+        /** Comma-separated list of the paths of the given fields, e.g.
+         * "depth, drive.thrust.yaw"
+         */
+        static std::string describeFields(std::bitset<STATE_FIELD_COUNT> const& fields);
+
+        /** The top-level method field of the last decoded message, e.g. "GET"
+         *
+         * Empty if the message has none
+         */
+        std::string const& getMethod() const;
+
+    private:
+        static const int MAX_PATH_DEPTH = 7;
+
+        char const* m_cursor = nullptr;
+        char const* m_end = nullptr;
+        std::string m_error;
+        std::string m_method;
+
+        std::array<std::string_view, MAX_PATH_DEPTH> m_path;
+        RawDeviceStates* m_device = nullptr;
+        ResolveDevice const* m_resolve = nullptr;
+
+        void skipWhitespace();
+        bool fail(std::string const& message);
+        bool parseValue(int depth);
+        bool parseObject(int depth);
+        bool parseArray(int depth);
+        bool parseString(std::string_view& str);
+        bool parseNumber(double& value);
+        bool parseLiteral(char const* literal, size_t length);
+        void storeValue(int depth, double value);
+    };
+}
+
+#endif
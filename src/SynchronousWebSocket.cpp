@@ -1,20 +1,32 @@
 #include <base-logging/Logging.hpp>
 #include <deep_trekker/SynchronousWebSocket.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <random>
+
 using namespace deep_trekker;
 using namespace rtc;
 using namespace std;
 
+static uint64_t microsecondsSince(chrono::steady_clock::time_point start)
+{
+    auto elapsed = chrono::steady_clock::now() - start;
+    return chrono::duration_cast<chrono::microseconds>(elapsed).count();
+}
+
 SynchronousWebSocket::SynchronousWebSocket(string const& debug_name)
     : SynchronousWebSocket(WebSocket::Configuration(), debug_name)
 {
     m_on_error = [](std::string const&) {};
     m_on_json_error = [](std::string const&) {};
-    m_on_json_message = [](Json::Value const&) {};
 }
 
 SynchronousWebSocket::~SynchronousWebSocket()
 {
+    disableAutoReconnect();
+    m_send_coalescer.reset();
+    stopDispatchThread();
     delete m_json_reader;
 }
 
@@ -26,73 +38,337 @@ SynchronousWebSocket::SynchronousWebSocket(WebSocket::Configuration const& confi
     Json::CharReaderBuilder builder;
     m_json_reader = builder.newCharReader();
 
-    m_ws.onMessage([&](std::variant<rtc::binary, string> const& data) {
+    m_ws.onMessage([&](std::variant<rtc::binary, string> data) {
+        auto receive_time = base::Time::now();
         if (!holds_alternative<string>(data)) {
             m_on_json_error("received binary message, expected string");
             return;
         }
+        receiveFrame(move(get<string>(data)), receive_time);
+    });
+}
+
+void SynchronousWebSocket::receiveFrame(string frame, base::Time const& receive_time)
+{
+    if (m_dispatch_queue) {
+        Frame queued{move(frame), receive_time};
+        queueFrame(queued);
+    }
+    else {
+        dispatchFrame(frame, receive_time);
+    }
+}
+
+void SynchronousWebSocket::startDispatchThread(size_t capacity, OverflowPolicy policy)
+{
+    stopDispatchThread();
+
+    m_dispatch_queue.reset(new BoundedQueue<Frame>(capacity));
+    m_overflow_policy = policy;
+    m_dispatch_quit = false;
+    m_max_queue_depth = 0;
+    m_queued_frames = 0;
+    m_dropped_frames = 0;
+    m_dispatched_frames = 0;
+    m_dispatch_thread = thread([this] { dispatchLoop(); });
+}
+
+void SynchronousWebSocket::stopDispatchThread()
+{
+    if (!m_dispatch_thread.joinable()) {
+        return;
+    }
+
+    {
+        lock_guard<mutex> lock(m_dispatch_mutex);
+        m_dispatch_quit = true;
+    }
+    m_frame_queued.notify_one();
+    m_frame_dequeued.notify_all();
+    m_dispatch_thread.join();
+    m_dispatch_queue.reset();
+}
+
+bool SynchronousWebSocket::hasDispatchThread() const
+{
+    return m_dispatch_thread.joinable();
+}
+
+SynchronousWebSocket::DispatchQueueStats SynchronousWebSocket::getDispatchQueueStats()
+    const
+{
+    DispatchQueueStats stats;
+    if (m_dispatch_queue) {
+        stats.capacity = m_dispatch_queue->capacity();
+        stats.depth = m_dispatch_queue->size();
+    }
+    stats.max_depth = m_max_queue_depth;
+    stats.queued = m_queued_frames;
+    stats.dropped = m_dropped_frames;
+    stats.dispatched = m_dispatched_frames;
+    return stats;
+}
+
+void SynchronousWebSocket::queueFrame(Frame& frame)
+{
+    while (!m_dispatch_queue->tryPush(frame)) {
+        if (m_overflow_policy == OVERFLOW_DROP_NEWEST) {
+            m_dropped_frames++;
+            return;
+        }
+        else if (m_overflow_policy == OVERFLOW_DROP_OLDEST) {
+            Frame oldest;
+            if (m_dispatch_queue->tryPop(oldest)) {
+                m_dropped_frames++;
+            }
+        }
+        else {
+            unique_lock<mutex> lock(m_dispatch_mutex);
+            m_frame_dequeued.wait(lock, [this] {
+                return m_dispatch_quit ||
+                       m_dispatch_queue->size() < m_dispatch_queue->capacity();
+            });
+            if (m_dispatch_quit) {
+                m_dropped_frames++;
+                return;
+            }
+        }
+    }
+
+    m_queued_frames++;
+    size_t depth = m_dispatch_queue->size();
+    if (depth > m_max_queue_depth) {
+        m_max_queue_depth = depth;
+    }
+    // Taking the lock guarantees that the dispatch thread is either waiting, and
+    // receives the notification, or did not check the queue yet
+    { lock_guard<mutex> lock(m_dispatch_mutex); }
+    m_frame_queued.notify_one();
+}
 
-        auto whole_msg = get<string>(data);
-        string msg;
-        // \x1e is the separator in SignalR
-        stringstream whole_msg_ss(whole_msg);
-        while (getline(whole_msg_ss, msg, '\x1e')) {
-            dispatchMessage(msg);
+void SynchronousWebSocket::dispatchLoop()
+{
+    while (true) {
+        Frame frame;
+        if (m_dispatch_queue->tryPop(frame)) {
+            if (m_overflow_policy == OVERFLOW_BLOCK) {
+                { lock_guard<mutex> lock(m_dispatch_mutex); }
+                m_frame_dequeued.notify_one();
+            }
+            dispatchFrame(frame.data, frame.receive_time);
+            m_dispatched_frames++;
+            continue;
         }
+
+        unique_lock<mutex> lock(m_dispatch_mutex);
+        m_frame_queued.wait(lock,
+            [this] { return m_dispatch_quit || !m_dispatch_queue->empty(); });
+        if (m_dispatch_quit && m_dispatch_queue->empty()) {
+            return;
+        }
+    }
+}
+
+void SynchronousWebSocket::dispatchFrame(string_view frame,
+    base::Time const& receive_time)
+{
+    size_t records = 0;
+    splitRecords(frame, [&](string_view msg) {
+        dispatchMessage(msg, receive_time);
+        records++;
     });
+    m_metrics.recordFrame(frame.size(), records);
 }
 
-void SynchronousWebSocket::dispatchMessage(string const& msg)
+void SynchronousWebSocket::dispatchMessage(string_view msg,
+    base::Time const& receive_time)
 {
+    LOG_DEBUG_S << "< " << m_debug_name << ": " << msg << endl;
+    uint64_t callback_time_us = 0;
+    if (m_on_message) {
+        auto start = chrono::steady_clock::now();
+        try {
+            m_on_message(msg, receive_time);
+        }
+        catch (std::exception& e) {
+            LOG_ERROR_S << m_debug_name << ": unhandled exception in message handler";
+            LOG_ERROR_S << m_debug_name << ": " << e.what();
+        }
+        callback_time_us += microsecondsSince(start);
+    }
+    if (!m_on_json_message) {
+        m_metrics.recordCallbacks(callback_time_us);
+        return;
+    }
+
     Json::Value json;
+    auto parse_start = chrono::steady_clock::now();
+    bool parsed = true;
     try {
-        LOG_DEBUG_S << "< " << m_debug_name << ": " << msg << endl;
         json = jsonParse(msg);
     }
     catch (std::exception& e) {
+        parsed = false;
         m_on_json_error(e.what());
     }
+    m_metrics.recordParse(microsecondsSince(parse_start), parsed);
 
+    auto start = chrono::steady_clock::now();
     try {
-        m_on_json_message(json);
+        m_on_json_message(json, receive_time);
     }
     catch (std::exception& e) {
         LOG_ERROR_S << m_debug_name << ": unhandled exception in JSON message handler";
         LOG_ERROR_S << m_debug_name << ": " << e.what();
     }
+    callback_time_us += microsecondsSince(start);
+    m_metrics.recordCallbacks(callback_time_us);
+}
+
+WebSocketMetricsSnapshot SynchronousWebSocket::getMetrics() const
+{
+    auto metrics = m_metrics.snapshot();
+    metrics.send_buffered_bytes = m_ws.bufferedAmount();
+    auto dispatch = getDispatchQueueStats();
+    metrics.dispatch_queue_depth = dispatch.depth;
+    metrics.max_dispatch_queue_depth = dispatch.max_depth;
+    return metrics;
+}
+
+void SynchronousWebSocket::resetMetrics()
+{
+    m_metrics.reset();
+}
+
+/** Wait for the completion of a future returned by openAsync or closeAsync
+ *
+ * @return false if the deadline passed before it completed
+ */
+static bool waitCompletion(future<void>& future,
+    chrono::steady_clock::time_point deadline)
+{
+    if (future.wait_until(deadline) != future_status::ready) {
+        return false;
+    }
+    future.get();
+    return true;
+}
+
+static chrono::steady_clock::time_point deadlineFromTimeout(base::Time const& timeout)
+{
+    return chrono::steady_clock::now() + chrono::microseconds(timeout.toMicroseconds());
+}
+
+/** Adapt an OnCompletion callback to fulfill a promise */
+static SynchronousWebSocket::OnCompletion fulfill(shared_ptr<promise<void>> promise)
+{
+    return [promise](exception_ptr error) {
+        if (error) {
+            promise->set_exception(error);
+        }
+        else {
+            promise->set_value();
+        }
+    };
 }
 
 void SynchronousWebSocket::open(string const& url, base::Time const& timeout)
 {
-    promise<void> promise;
-    auto future = promise.get_future();
+    auto future = openAsync(url);
+    if (!waitCompletion(future, deadlineFromTimeout(timeout))) {
+        throw std::runtime_error(
+            "timed out waiting for the websocket connection with " + m_debug_name);
+    }
 
-    m_ws.onOpen([&promise, name = m_debug_name]() {
-        LOG_DEBUG_S << "websocket opened to " << name;
-        promise.set_value();
+    LOG_DEBUG_S << "successfully opened connection to " << m_debug_name;
+}
+
+void SynchronousWebSocket::openAsync(string const& url, OnCompletion callback)
+{
+    auto start = base::Time::now();
+    // Only the first of the open and error events completes the operation
+    auto completed = make_shared<atomic<bool>>(false);
+
+    m_ws.onOpen([this, completed, callback, start]() {
+        if (completed->exchange(true)) {
+            return;
+        }
+        LOG_DEBUG_S << "websocket opened to " << m_debug_name;
+        m_ws.onError(m_on_error);
+        m_metrics.recordOpen(base::Time::now() - start);
+        handleConnected();
+        callback(nullptr);
     });
-    m_ws.onError([&promise, name = m_debug_name](string const& error) {
-        LOG_DEBUG_S << "websocket error to " << name;
-        promise.set_exception(make_exception_ptr(runtime_error(error)));
+    m_ws.onError([this, completed, callback](string const& error) {
+        if (completed->exchange(true)) {
+            return;
+        }
+        LOG_DEBUG_S << "websocket error to " << m_debug_name;
+        callback(make_exception_ptr(runtime_error(error)));
     });
 
+    {
+        lock_guard<mutex> lock(m_reconnect_mutex);
+        m_url = url;
+    }
     m_ws.open(url);
-    if (future.wait_for(chrono::microseconds(timeout.toMicroseconds())) !=
-        future_status::ready) {
-        throw std::runtime_error(
-            "timed out waiting for the websocket connection with " + m_debug_name);
+}
+
+future<void> SynchronousWebSocket::openAsync(string const& url)
+{
+    auto promise = make_shared<std::promise<void>>();
+    auto future = promise->get_future();
+    openAsync(url, fulfill(promise));
+    return future;
+}
+
+void SynchronousWebSocket::openAll(
+    vector<pair<SynchronousWebSocket*, string>> const& sockets,
+    base::Time const& timeout)
+{
+    vector<future<void>> futures;
+    for (auto const& socket : sockets) {
+        futures.push_back(socket.first->openAsync(socket.second));
     }
-    future.get();
-    m_ws.onError(m_on_error);
 
-    LOG_DEBUG_S << "successfully opened connection to " << m_debug_name;
+    auto deadline = deadlineFromTimeout(timeout);
+    exception_ptr first_error;
+    for (size_t i = 0; i < futures.size(); ++i) {
+        try {
+            if (!waitCompletion(futures[i], deadline)) {
+                throw std::runtime_error(
+                    "timed out waiting for the websocket connection with " +
+                    sockets[i].first->m_debug_name);
+            }
+        }
+        catch (std::exception&) {
+            if (!first_error) {
+                first_error = current_exception();
+            }
+        }
+    }
+    if (first_error) {
+        rethrow_exception(first_error);
+    }
 }
 
 void SynchronousWebSocket::onJSONMessage(OnJSONMessage callback)
+{
+    m_on_json_message = [callback](Json::Value const& msg, base::Time const&) {
+        callback(msg);
+    };
+}
+
+void SynchronousWebSocket::onJSONMessage(OnTimestampedJSONMessage callback)
 {
     m_on_json_message = callback;
 }
 
+void SynchronousWebSocket::onMessage(OnTimestampedMessage callback)
+{
+    m_on_message = callback;
+}
+
 void SynchronousWebSocket::onJSONError(OnError callback)
 {
     m_on_json_error = callback;
@@ -114,28 +390,306 @@ void SynchronousWebSocket::send(Json::Value const& msg)
 void SynchronousWebSocket::send(std::string const& msg)
 {
     LOG_DEBUG_S << "> " << m_debug_name << ": " << msg << endl;
-    m_ws.send(msg);
+    if (m_send_coalescer) {
+        m_send_coalescer->send(msg);
+    }
+    else {
+        sendFrame(msg, 1);
+    }
+}
+
+void SynchronousWebSocket::sendNow(std::string const& msg)
+{
+    LOG_DEBUG_S << "> " << m_debug_name << ": " << msg << endl;
+    if (m_send_coalescer) {
+        m_send_coalescer->sendNow(msg);
+    }
+    else {
+        sendFrame(msg, 1);
+    }
+}
+
+void SynchronousWebSocket::sendFrame(string const& frame, size_t message_count)
+{
+    if (m_auto_reconnect && !m_connected) {
+        LOG_WARN_S << m_debug_name << ": not connected, dropping " << message_count
+                   << " message(s)";
+        return;
+    }
+
+    m_ws.send(frame);
+    m_metrics.recordSent(frame.size(), message_count, m_ws.bufferedAmount());
+}
+
+void SynchronousWebSocket::enableSendCoalescing(base::Time const& window,
+    size_t max_batch_bytes)
+{
+    m_send_coalescer.reset(new SendCoalescer(
+        [this](string const& frame, size_t count) { sendFrame(frame, count); },
+        window,
+        max_batch_bytes));
+}
+
+void SynchronousWebSocket::disableSendCoalescing()
+{
+    m_send_coalescer.reset();
+}
+
+void SynchronousWebSocket::flush()
+{
+    if (m_send_coalescer) {
+        m_send_coalescer->flush();
+    }
 }
 
 void SynchronousWebSocket::close(base::Time const& timeout)
 {
-    promise<void> promise;
-    auto future = promise.get_future();
+    auto future = closeAsync();
+    if (!waitCompletion(future, deadlineFromTimeout(timeout))) {
+        throw std::runtime_error("timed out waiting for the websocket connection");
+    }
+}
+
+void SynchronousWebSocket::closeAsync(OnCompletion callback)
+{
+    disableAutoReconnect();
+    flush();
+    m_connected = false;
 
-    m_ws.onClosed([&promise]() { promise.set_value(); });
-    m_ws.onError([&promise](string const& error) {
-        promise.set_exception(make_exception_ptr(runtime_error(error)));
+    auto start = base::Time::now();
+    auto completed = make_shared<atomic<bool>>(false);
+    m_ws.onClosed([this, completed, callback, start]() {
+        if (completed->exchange(true)) {
+            return;
+        }
+        m_metrics.recordClose(base::Time::now() - start);
+        callback(nullptr);
+    });
+    m_ws.onError([completed, callback](string const& error) {
+        if (completed->exchange(true)) {
+            return;
+        }
+        callback(make_exception_ptr(runtime_error(error)));
     });
 
     m_ws.close();
-    if (future.wait_for(chrono::microseconds(timeout.toMicroseconds())) !=
-        future_status::ready) {
-        throw std::runtime_error("timed out waiting for the websocket connection");
+}
+
+future<void> SynchronousWebSocket::closeAsync()
+{
+    auto promise = make_shared<std::promise<void>>();
+    auto future = promise->get_future();
+    closeAsync(fulfill(promise));
+    return future;
+}
+
+void SynchronousWebSocket::closeAll(vector<SynchronousWebSocket*> const& sockets,
+    base::Time const& timeout)
+{
+    vector<future<void>> futures;
+    for (auto socket : sockets) {
+        futures.push_back(socket->closeAsync());
+    }
+
+    auto deadline = deadlineFromTimeout(timeout);
+    exception_ptr first_error;
+    for (auto& future : futures) {
+        try {
+            if (!waitCompletion(future, deadline)) {
+                throw std::runtime_error(
+                    "timed out waiting for the websocket connection");
+            }
+        }
+        catch (std::exception&) {
+            if (!first_error) {
+                first_error = current_exception();
+            }
+        }
+    }
+    if (first_error) {
+        rethrow_exception(first_error);
+    }
+}
+
+void SynchronousWebSocket::onConnected(OnConnectionEvent callback)
+{
+    m_on_connected = callback;
+}
+
+void SynchronousWebSocket::onDisconnected(OnConnectionEvent callback)
+{
+    m_on_disconnected = callback;
+}
+
+bool SynchronousWebSocket::isConnected() const
+{
+    return m_connected;
+}
+
+base::Time SynchronousWebSocket::ReconnectPolicy::delayFor(unsigned int attempt,
+    double jitter_sample) const
+{
+    if (attempt == 0) {
+        return base::Time();
+    }
+
+    double delay = initial_delay.toSeconds() * pow(multiplier, attempt - 1);
+    delay = min(delay, max_delay.toSeconds());
+    delay *= 1 + jitter * jitter_sample;
+    return base::Time::fromSeconds(max(delay, 0.0));
+}
+
+void SynchronousWebSocket::enableAutoReconnect(ReconnectPolicy const& policy)
+{
+    disableAutoReconnect();
+
+    m_reconnect_policy = policy;
+    m_reconnect_quit = false;
+    m_auto_reconnect = true;
+    m_reconnect_thread = thread([this] { reconnectLoop(); });
+}
+
+void SynchronousWebSocket::enableAutoReconnect()
+{
+    enableAutoReconnect(ReconnectPolicy());
+}
+
+void SynchronousWebSocket::disableAutoReconnect()
+{
+    if (!m_reconnect_thread.joinable()) {
+        return;
+    }
+
+    {
+        lock_guard<mutex> lock(m_reconnect_mutex);
+        m_reconnect_quit = true;
+    }
+    m_reconnect_signal.notify_all();
+    m_reconnect_thread.join();
+    m_auto_reconnect = false;
+}
+
+bool SynchronousWebSocket::hasAutoReconnect() const
+{
+    return m_auto_reconnect;
+}
+
+void SynchronousWebSocket::handleConnected()
+{
+    {
+        lock_guard<mutex> lock(m_reconnect_mutex);
+        m_disconnected = false;
+    }
+    m_connected = true;
+    m_ws.onClosed([this]() { handleClosed(); });
+    if (m_on_connected) {
+        m_on_connected();
+    }
+}
+
+void SynchronousWebSocket::handleClosed()
+{
+    if (!m_connected.exchange(false)) {
+        return;
+    }
+
+    LOG_WARN_S << "lost websocket connection to " << m_debug_name;
+    m_metrics.recordDisconnect();
+    if (m_on_disconnected) {
+        m_on_disconnected();
+    }
+
+    {
+        lock_guard<mutex> lock(m_reconnect_mutex);
+        m_disconnected = true;
+    }
+    m_reconnect_signal.notify_all();
+}
+
+void SynchronousWebSocket::startReconnectAttempt(string const& url)
+{
+    uint64_t attempt_id;
+    {
+        lock_guard<mutex> lock(m_reconnect_mutex);
+        attempt_id = ++m_reconnect_attempt_id;
+        m_attempt_completed = false;
+        m_attempt_error = nullptr;
+    }
+
+    openAsync(url, [this, attempt_id](exception_ptr error) {
+        {
+            lock_guard<mutex> lock(m_reconnect_mutex);
+            if (attempt_id != m_reconnect_attempt_id) {
+                return;
+            }
+            m_attempt_completed = true;
+            m_attempt_error = error;
+        }
+        m_reconnect_signal.notify_all();
+    });
+}
+
+void SynchronousWebSocket::reconnectLoop()
+{
+    mt19937 random(random_device{}());
+    uniform_real_distribution<double> jitter(-1, 1);
+    auto stopping = [this] { return m_reconnect_quit; };
+
+    unique_lock<mutex> lock(m_reconnect_mutex);
+    unsigned int attempt = 0;
+    while (!m_reconnect_quit) {
+        if (!m_disconnected) {
+            attempt = 0;
+            m_reconnect_signal.wait(lock);
+            continue;
+        }
+
+        auto delay = m_reconnect_policy.delayFor(attempt++, jitter(random));
+        auto delay_us = chrono::microseconds(delay.toMicroseconds());
+        if (m_reconnect_signal.wait_for(lock, delay_us, stopping)) {
+            break;
+        }
+
+        string url = m_url;
+        lock.unlock();
+        LOG_INFO_S << "reconnecting to " << m_debug_name << ", attempt " << attempt;
+        try {
+            startReconnectAttempt(url);
+        }
+        catch (std::exception& e) {
+            LOG_ERROR_S << "failed to reconnect to " << m_debug_name << ": "
+                        << e.what();
+            lock.lock();
+            continue;
+        }
+        lock.lock();
+
+        auto timeout_us =
+            chrono::microseconds(m_reconnect_policy.attempt_timeout.toMicroseconds());
+        m_reconnect_signal.wait_for(lock, timeout_us, [this] {
+            return m_reconnect_quit || m_attempt_completed;
+        });
+        if (m_attempt_completed && !m_attempt_error) {
+            LOG_INFO_S << "reconnected to " << m_debug_name;
+            continue;
+        }
+
+        // Abandon the attempt, so that a late completion is ignored
+        bool timed_out = !m_attempt_completed;
+        ++m_reconnect_attempt_id;
+        lock.unlock();
+        if (timed_out) {
+            LOG_ERROR_S << "timed out reconnecting to " << m_debug_name;
+            m_ws.forceClose();
+        }
+        else {
+            LOG_ERROR_S << "failed to reconnect to " << m_debug_name;
+        }
+        lock.lock();
     }
-    future.get();
 }
 
-Json::Value SynchronousWebSocket::jsonParse(std::string const& msg)
+Json::Value SynchronousWebSocket::jsonParse(string_view msg)
 {
     char const* begin = msg.data();
     char const* end = begin + msg.size();
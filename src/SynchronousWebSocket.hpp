@@ -1,18 +1,101 @@
 #ifndef DEEP_TREKKER_SYNCHRONOUSWEBSOCKET_HPP
 #define DEEP_TREKKER_SYNCHRONOUSWEBSOCKET_HPP
 
+#include <atomic>
 #include <base/Time.hpp>
+#include <condition_variable>
+#include <deep_trekker/BoundedQueue.hpp>
+#include <deep_trekker/SendCoalescer.hpp>
+#include <deep_trekker/WebSocketMetrics.hpp>
 #include <functional>
+#include <future>
 #include <json/json.h>
+#include <memory>
+#include <mutex>
 #include <rtc/rtc.hpp>
+#include <string_view>
+#include <thread>
+#include <vector>
 
 namespace deep_trekker {
     /** A thin wrapper over rtc::Websocket providing synchronous operations
+     *
+     * By default, the received messages are parsed and handed to the callbacks
+     * in libdatachannel's network thread. startDispatchThread moves this work to
+     * a dedicated thread, so that slow callbacks do not stall the network.
      */
     class SynchronousWebSocket {
     public:
         typedef std::function<void(std::string const&)> OnError;
         typedef std::function<void(Json::Value const&)> OnJSONMessage;
+        /** Callback receiving a message as received, along with its reception
+         * time
+         *
+         * The message points into the websocket frame, and is only valid during
+         * the call
+         */
+        typedef std::function<void(std::string_view, base::Time const&)>
+            OnTimestampedMessage;
+        /** Callback receiving a message along with the time at which the
+         * websocket frame that contained it was received
+         */
+        typedef std::function<void(Json::Value const&, base::Time const&)>
+            OnTimestampedJSONMessage;
+        /** Callback called when an asynchronous open or close finished
+         *
+         * \c error is null on success
+         */
+        typedef std::function<void(std::exception_ptr error)> OnCompletion;
+        /** Callback called when the connection is established or lost */
+        typedef std::function<void()> OnConnectionEvent;
+
+        /** What to do with a received frame when the dispatch queue is full */
+        enum OverflowPolicy {
+            /** Wait for the dispatch thread to make room
+             *
+             * Nothing is lost, but the network thread then waits for the
+             * message callbacks
+             */
+            OVERFLOW_BLOCK,
+            /** Drop the oldest queued frame to make room for the new one */
+            OVERFLOW_DROP_OLDEST,
+            /** Drop the received frame */
+            OVERFLOW_DROP_NEWEST
+        };
+
+        /** Statistics of the dispatch queue, see startDispatchThread */
+        struct DispatchQueueStats {
+            size_t capacity = 0;
+            /** Number of frames waiting to be dispatched */
+            size_t depth = 0;
+            /** Highest depth since the dispatch thread was started */
+            size_t max_depth = 0;
+            uint64_t queued = 0;
+            uint64_t dropped = 0;
+            uint64_t dispatched = 0;
+        };
+
+        /** How the websocket reconnects after losing its connection, see
+         * enableAutoReconnect
+         */
+        struct ReconnectPolicy {
+            /** Delay before the second attempt. The first one is immediate */
+            base::Time initial_delay = base::Time::fromMilliseconds(100);
+            /** Upper bound of the delay between two attempts */
+            base::Time max_delay = base::Time::fromSeconds(5);
+            /** Factor applied to the delay after each failed attempt */
+            double multiplier = 2;
+            /** Relative amplitude of the random variation of each delay */
+            double jitter = 0.2;
+            /** Time after which a connection attempt is considered failed */
+            base::Time attempt_timeout = base::Time::fromSeconds(2);
+
+            /** The delay before the given attempt, counted from zero
+             *
+             * @param jitter_sample a random value in [-1, 1], scaled by \c jitter
+             */
+            base::Time delayFor(unsigned int attempt, double jitter_sample) const;
+        };
 
     private:
         rtc::WebSocket m_ws;
@@ -21,9 +104,64 @@ namespace deep_trekker {
         Json::CharReader* m_json_reader = nullptr;
         OnError m_on_error;
         OnError m_on_json_error;
-        OnJSONMessage m_on_json_message;
+        OnTimestampedJSONMessage m_on_json_message;
+        OnTimestampedMessage m_on_message;
+
+        /** A received frame, waiting in the dispatch queue */
+        struct Frame {
+            std::string data;
+            base::Time receive_time;
+        };
+        std::unique_ptr<BoundedQueue<Frame>> m_dispatch_queue;
+        OverflowPolicy m_overflow_policy = OVERFLOW_BLOCK;
+        std::thread m_dispatch_thread;
+        std::mutex m_dispatch_mutex;
+        /** Signalled when a frame is queued, or when the thread must quit */
+        std::condition_variable m_frame_queued;
+        /** Signalled when a frame is dequeued, for OVERFLOW_BLOCK */
+        std::condition_variable m_frame_dequeued;
+        bool m_dispatch_quit = false;
+        std::atomic<size_t> m_max_queue_depth{0};
+        std::atomic<uint64_t> m_queued_frames{0};
+        std::atomic<uint64_t> m_dropped_frames{0};
+        std::atomic<uint64_t> m_dispatched_frames{0};
+
+        WebSocketMetrics m_metrics;
+        std::unique_ptr<SendCoalescer> m_send_coalescer;
 
-        void dispatchMessage(std::string const& msg);
+        OnConnectionEvent m_on_connected;
+        OnConnectionEvent m_on_disconnected;
+        /** Whether the websocket is open, and was neither closed by us nor lost */
+        std::atomic<bool> m_connected{false};
+        std::atomic<bool> m_auto_reconnect{false};
+        ReconnectPolicy m_reconnect_policy;
+        std::thread m_reconnect_thread;
+        std::mutex m_reconnect_mutex;
+        /** Signalled when the connection is lost, when a connection attempt
+         * completes, or when the reconnect thread must quit
+         */
+        std::condition_variable m_reconnect_signal;
+        std::string m_url;
+        bool m_reconnect_quit = false;
+        bool m_disconnected = false;
+        /** Identifies the current connection attempt, so that the completion
+         * of an abandoned attempt is ignored
+         */
+        uint64_t m_reconnect_attempt_id = 0;
+        bool m_attempt_completed = false;
+        std::exception_ptr m_attempt_error;
+
+        void sendFrame(std::string const& frame, size_t message_count);
+
+        void queueFrame(Frame& frame);
+        void dispatchLoop();
+        void dispatchFrame(std::string_view frame, base::Time const& receive_time);
+        void dispatchMessage(std::string_view msg, base::Time const& receive_time);
+
+        void handleConnected();
+        void handleClosed();
+        void reconnectLoop();
+        void startReconnectAttempt(std::string const& url);
 
     public:
         SynchronousWebSocket(std::string const& debug_name = "");
@@ -38,28 +176,195 @@ namespace deep_trekker {
          */
         void open(std::string const& url, base::Time const& timeout);
 
+        /** Asynchronously open the websocket
+         *
+         * \c callback is called from the network thread once the websocket is
+         * opened, or with the error that prevented it. There is no timeout
+         * other than the configuration's connectionTimeout.
+         */
+        void openAsync(std::string const& url, OnCompletion callback);
+
+        /** Asynchronously open the websocket
+         *
+         * @return a future that becomes ready once the websocket is opened, or
+         *   holds the error that prevented it
+         */
+        std::future<void> openAsync(std::string const& url);
+
         /** Synchronously close the websocket
          *
          * At the end of the call, either the websocket is closed, or the
-         * method throws an exception after `timeout` elapsed
+         * method throws an exception after `timeout` elapsed. Closing the
+         * websocket disables auto-reconnect.
          */
         void close(base::Time const& timeout);
 
+        /** Asynchronously close the websocket, see openAsync and close */
+        void closeAsync(OnCompletion callback);
+
+        /** Asynchronously close the websocket, see openAsync */
+        std::future<void> closeAsync();
+
+        /** Open several websockets concurrently
+         *
+         * It returns once they are all opened, or throws the first error
+         * once all of them are either opened, failed or timed out. The
+         * websockets that did open are left open.
+         *
+         * @param sockets the websockets, along with the URL to open
+         */
+        static void openAll(
+            std::vector<std::pair<SynchronousWebSocket*, std::string>> const& sockets,
+            base::Time const& timeout);
+
+        /** Close several websockets concurrently, see openAll */
+        static void closeAll(std::vector<SynchronousWebSocket*> const& sockets,
+            base::Time const& timeout);
+
         /** Send a message */
         void send(Json::Value const& msg);
 
-        /** Send a message */
+        /** Send a message
+         *
+         * If send coalescing is enabled, the message may be held for up to the
+         * coalescing window, see enableSendCoalescing
+         */
         void send(std::string const& msg);
 
+        /** Send a latency-critical message right away
+         *
+         * If send coalescing is enabled, the pending messages are sent along
+         * with it
+         */
+        void sendNow(std::string const& msg);
+
+        /** Join the messages sent within \c window in a single frame
+         *
+         * Only the \x1e-terminated messages, as in SignalR, are joined. The
+         * others keep their own frame. See SendCoalescer for the details.
+         *
+         * Do not call it concurrently with the send methods
+         */
+        void enableSendCoalescing(base::Time const& window,
+            size_t max_batch_bytes = 65536);
+        /** Send the pending messages, and go back to one frame per message */
+        void disableSendCoalescing();
+        /** Send the messages held by send coalescing */
+        void flush();
+
         /** Register a callback to receive messages parsed as JSON */
         void onJSONMessage(OnJSONMessage callback);
+        /** Register a callback to receive messages parsed as JSON, along with
+         * their reception time
+         *
+         * The time is read once per websocket frame, before any processing. All
+         * the messages of a frame share the same time.
+         */
+        void onJSONMessage(OnTimestampedJSONMessage callback);
+        /** Register a callback to receive the messages before JSON parsing
+         *
+         * The messages are not parsed as JSON if no JSON message callback is
+         * registered
+         */
+        void onMessage(OnTimestampedMessage callback);
         /** Register a callback to receive errors during JSON parsing */
         void onJSONError(OnError callback);
         /** Register a callback to receive websocket errors */
         void onWebSocketError(OnError callback);
 
-        Json::Value jsonParse(std::string const& msg);
+        /** Register a callback called each time the websocket is opened,
+         * including by auto-reconnect
+         *
+         * It is called from the network thread. Register it before open.
+         */
+        void onConnected(OnConnectionEvent callback);
+        /** Register a callback called when the connection is lost
+         *
+         * It is not called when the websocket is closed with close or
+         * closeAsync. It is called from the network thread. Register it before
+         * open.
+         */
+        void onDisconnected(OnConnectionEvent callback);
+
+        /** Reopen the websocket when its connection is lost
+         *
+         * A background thread reopens the URL given to the last open, keeping
+         * all the registered callbacks, and retries with exponential backoff
+         * until it succeeds. The first attempt is immediate, so that a brief
+         * network glitch costs about one connection round trip.
+         *
+         * The messages sent while the connection is down are dropped. Protocols
+         * that keep a session on the server side may need to restart it, see
+         * onConnected.
+         *
+         * Do not call it concurrently with open or close
+         */
+        void enableAutoReconnect(ReconnectPolicy const& policy);
+        /** Reopen the websocket when its connection is lost, with the default
+         * policy
+         */
+        void enableAutoReconnect();
+        /** Stop reconnecting, waiting for the attempt in progress if any */
+        void disableAutoReconnect();
+        bool hasAutoReconnect() const;
+        /** Whether the websocket is open and its connection was not lost */
+        bool isConnected() const;
+
+        /** Parse and dispatch the received messages in a dedicated thread
+         *
+         * The network thread then only moves the received frames into a queue
+         * of \c capacity frames (rounded up to a power of two, at least 2),
+         * whose overflow is handled according to \c policy. The callbacks are
+         * all called from the dispatch thread.
+         *
+         * Call it before open, or while the websocket is closed
+         */
+        void startDispatchThread(size_t capacity, OverflowPolicy policy);
+        /** Stop the dispatch thread, after it dispatched the queued frames
+         *
+         * The messages are dispatched in the network thread again. Call it while
+         * the websocket is closed. It is called by the destructor.
+         */
+        void stopDispatchThread();
+        bool hasDispatchThread() const;
+        /** Handle a text frame as if it was received from the network
+         *
+         * This is what the network thread does with each frame. It queues the
+         * frame if the dispatch thread is running, and dispatches it otherwise.
+         * It allows to exercise the dispatch without a connection.
+         */
+        void receiveFrame(std::string frame, base::Time const& receive_time);
+        DispatchQueueStats getDispatchQueueStats() const;
+
+        /** Traffic and timing metrics of the connection
+         *
+         * The counters are always updated, and cover the whole life of the
+         * object, or the time since the last call to resetMetrics
+         */
+        WebSocketMetricsSnapshot getMetrics() const;
+        void resetMetrics();
+
+        Json::Value jsonParse(std::string_view msg);
         static std::string jsonToString(Json::Value const& arg);
+
+        /** Call \c callback with each record of a websocket frame
+         *
+         * Records are separated by \x1e, the SignalR record separator. They are
+         * views over \c frame, which is not copied. As with std::getline, a
+         * trailing separator does not start a new, empty, record.
+         */
+        template <typename Callback>
+        static void splitRecords(std::string_view frame, Callback&& callback)
+        {
+            while (!frame.empty()) {
+                size_t separator = frame.find('\x1e');
+                callback(frame.substr(0, separator));
+                if (separator == std::string_view::npos) {
+                    return;
+                }
+                frame.remove_prefix(separator + 1);
+            }
+        }
     };
 }
 
@@ -0,0 +1,203 @@
+#include "WebSocketMetrics.hpp"
+#include <sstream>
+
+using namespace std;
+using namespace base;
+using namespace deep_trekker;
+
+static void atomicMax(atomic<uint64_t>& target, uint64_t value)
+{
+    uint64_t current = target.load(memory_order_relaxed);
+    while (value > current &&
+           !target.compare_exchange_weak(current, value, memory_order_relaxed)) {
+    }
+}
+
+int Log2Histogram::binOf(uint64_t value)
+{
+    int bin = 0;
+    while (value && bin < BIN_COUNT - 1) {
+        value >>= 1;
+        ++bin;
+    }
+    return bin;
+}
+
+void Log2Histogram::add(uint64_t value)
+{
+    bins[binOf(value)]++;
+    count++;
+    sum += value;
+    max = std::max(max, value);
+}
+
+double Log2Histogram::mean() const
+{
+    return count ? static_cast<double>(sum) / count : 0;
+}
+
+uint64_t Log2Histogram::quantileUpperBound(double q) const
+{
+    if (!count) {
+        return 0;
+    }
+
+    uint64_t rank = static_cast<uint64_t>(q * (count - 1)) + 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < BIN_COUNT - 1; ++i) {
+        seen += bins[i];
+        if (seen >= rank) {
+            return std::min((uint64_t(1) << i) - 1, max);
+        }
+    }
+    return max;
+}
+
+void AtomicLog2Histogram::add(uint64_t value)
+{
+    m_bins[Log2Histogram::binOf(value)].fetch_add(1, memory_order_relaxed);
+    m_count.fetch_add(1, memory_order_relaxed);
+    m_sum.fetch_add(value, memory_order_relaxed);
+    atomicMax(m_max, value);
+}
+
+Log2Histogram AtomicLog2Histogram::snapshot() const
+{
+    Log2Histogram result;
+    for (int i = 0; i < Log2Histogram::BIN_COUNT; ++i) {
+        result.bins[i] = m_bins[i].load(memory_order_relaxed);
+    }
+    result.count = m_count.load(memory_order_relaxed);
+    result.sum = m_sum.load(memory_order_relaxed);
+    result.max = m_max.load(memory_order_relaxed);
+    return result;
+}
+
+void AtomicLog2Histogram::reset()
+{
+    for (auto& bin : m_bins) {
+        bin.store(0, memory_order_relaxed);
+    }
+    m_count.store(0, memory_order_relaxed);
+    m_sum.store(0, memory_order_relaxed);
+    m_max.store(0, memory_order_relaxed);
+}
+
+void WebSocketMetrics::recordSent(size_t bytes, size_t messages, size_t buffered_bytes)
+{
+    m_sent_frames.fetch_add(1, memory_order_relaxed);
+    m_sent_messages.fetch_add(messages, memory_order_relaxed);
+    m_sent_bytes.fetch_add(bytes, memory_order_relaxed);
+    atomicMax(m_max_send_buffered_bytes, buffered_bytes);
+}
+
+void WebSocketMetrics::recordFrame(size_t bytes, size_t records)
+{
+    m_received_frames.fetch_add(1, memory_order_relaxed);
+    m_received_messages.fetch_add(records, memory_order_relaxed);
+    m_received_bytes.fetch_add(bytes, memory_order_relaxed);
+    m_records_per_frame.add(records);
+}
+
+void WebSocketMetrics::recordParse(uint64_t duration_us, bool success)
+{
+    m_parse_time_us.add(duration_us);
+    if (!success) {
+        m_json_errors.fetch_add(1, memory_order_relaxed);
+    }
+}
+
+void WebSocketMetrics::recordCallbacks(uint64_t duration_us)
+{
+    m_callback_time_us.add(duration_us);
+}
+
+void WebSocketMetrics::recordOpen(Time const& duration)
+{
+    m_open_count.fetch_add(1, memory_order_relaxed);
+    m_last_open_duration_us.store(duration.toMicroseconds(), memory_order_relaxed);
+}
+
+void WebSocketMetrics::recordClose(Time const& duration)
+{
+    m_close_count.fetch_add(1, memory_order_relaxed);
+    m_last_close_duration_us.store(duration.toMicroseconds(), memory_order_relaxed);
+}
+
+void WebSocketMetrics::recordDisconnect()
+{
+    m_disconnect_count.fetch_add(1, memory_order_relaxed);
+}
+
+WebSocketMetricsSnapshot WebSocketMetrics::snapshot() const
+{
+    WebSocketMetricsSnapshot result;
+    result.time = Time::now();
+    result.sent_frames = m_sent_frames.load(memory_order_relaxed);
+    result.sent_messages = m_sent_messages.load(memory_order_relaxed);
+    result.sent_bytes = m_sent_bytes.load(memory_order_relaxed);
+    result.received_frames = m_received_frames.load(memory_order_relaxed);
+    result.received_messages = m_received_messages.load(memory_order_relaxed);
+    result.received_bytes = m_received_bytes.load(memory_order_relaxed);
+    result.json_errors = m_json_errors.load(memory_order_relaxed);
+    result.records_per_frame = m_records_per_frame.snapshot();
+    result.parse_time_us = m_parse_time_us.snapshot();
+    result.callback_time_us = m_callback_time_us.snapshot();
+    result.max_send_buffered_bytes = m_max_send_buffered_bytes.load(memory_order_relaxed);
+    result.open_count = m_open_count.load(memory_order_relaxed);
+    result.close_count = m_close_count.load(memory_order_relaxed);
+    result.disconnect_count = m_disconnect_count.load(memory_order_relaxed);
+    result.last_open_duration =
+        Time::fromMicroseconds(m_last_open_duration_us.load(memory_order_relaxed));
+    result.last_close_duration =
+        Time::fromMicroseconds(m_last_close_duration_us.load(memory_order_relaxed));
+    return result;
+}
+
+void WebSocketMetrics::reset()
+{
+    m_sent_frames.store(0, memory_order_relaxed);
+    m_sent_messages.store(0, memory_order_relaxed);
+    m_sent_bytes.store(0, memory_order_relaxed);
+    m_received_frames.store(0, memory_order_relaxed);
+    m_received_messages.store(0, memory_order_relaxed);
+    m_received_bytes.store(0, memory_order_relaxed);
+    m_json_errors.store(0, memory_order_relaxed);
+    m_records_per_frame.reset();
+    m_parse_time_us.reset();
+    m_callback_time_us.reset();
+    m_max_send_buffered_bytes.store(0, memory_order_relaxed);
+    m_open_count.store(0, memory_order_relaxed);
+    m_close_count.store(0, memory_order_relaxed);
+    m_disconnect_count.store(0, memory_order_relaxed);
+    m_last_open_duration_us.store(0, memory_order_relaxed);
+    m_last_close_duration_us.store(0, memory_order_relaxed);
+}
+
+static void writeHistogram(ostream& out, char const* name, Log2Histogram const& h)
+{
+    out << " " << name << " mean=" << h.mean() << " p99<=" << h.quantileUpperBound(0.99)
+        << " max=" << h.max;
+}
+
+string WebSocketMetricsSnapshot::toString() const
+{
+    ostringstream out;
+    out << "sent " << sent_frames << " frames/" << sent_messages << " msgs/"
+        << sent_bytes << " B"
+        << ", received " << received_frames << " frames/" << received_messages
+        << " msgs/" << received_bytes << " B"
+        << ", json_errors=" << json_errors << ",";
+    writeHistogram(out, "records_per_frame", records_per_frame);
+    writeHistogram(out, "parse_us", parse_time_us);
+    writeHistogram(out, "callback_us", callback_time_us);
+    out << ", send_buffered=" << send_buffered_bytes << " B (max "
+        << max_send_buffered_bytes << " B)"
+        << ", dispatch_queue=" << dispatch_queue_depth << " (max "
+        << max_dispatch_queue_depth << ")"
+        << ", opened " << open_count << "x (last " << last_open_duration.toSeconds()
+        << " s), closed " << close_count << "x (last "
+        << last_close_duration.toSeconds() << " s), lost " << disconnect_count
+        << "x";
+    return out.str();
+}
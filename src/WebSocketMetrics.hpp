@@ -0,0 +1,134 @@
+#ifndef _DEEP_TREKKER_WEB_SOCKET_METRICS_HPP_
+#define _DEEP_TREKKER_WEB_SOCKET_METRICS_HPP_
+
+#include <array>
+#include <atomic>
+#include <base/Time.hpp>
+#include <cstdint>
+#include <string>
+
+namespace deep_trekker {
+    /** Histogram with power-of-two bins
+     *
+     * Bin 0 holds the zero values, and bin i the values in [2^(i-1), 2^i).
+     * The last bin also holds all the values above its lower bound.
+     */
+    struct Log2Histogram {
+        static const int BIN_COUNT = 32;
+
+        std::array<uint64_t, BIN_COUNT> bins{};
+        uint64_t count = 0;
+        uint64_t sum = 0;
+        uint64_t max = 0;
+
+        static int binOf(uint64_t value);
+        void add(uint64_t value);
+        double mean() const;
+        /** Upper bound of the bin that holds the q-quantile, 0 if empty */
+        uint64_t quantileUpperBound(double q) const;
+    };
+
+    /** Log2Histogram updated with relaxed atomics, and read with snapshot() */
+    class AtomicLog2Histogram {
+    public:
+        void add(uint64_t value);
+        Log2Histogram snapshot() const;
+        void reset();
+
+    private:
+        std::array<std::atomic<uint64_t>, Log2Histogram::BIN_COUNT> m_bins{};
+        std::atomic<uint64_t> m_count{0};
+        std::atomic<uint64_t> m_sum{0};
+        std::atomic<uint64_t> m_max{0};
+    };
+
+    /** The metrics of a websocket connection at a given time
+     *
+     * See SynchronousWebSocket::getMetrics
+     */
+    struct WebSocketMetricsSnapshot {
+        base::Time time;
+
+        uint64_t sent_frames = 0;
+        uint64_t sent_messages = 0;
+        uint64_t sent_bytes = 0;
+        uint64_t received_frames = 0;
+        uint64_t received_messages = 0;
+        uint64_t received_bytes = 0;
+        uint64_t json_errors = 0;
+
+        Log2Histogram records_per_frame;
+        /** JSON parse time of each message, in microseconds */
+        Log2Histogram parse_time_us;
+        /** Time spent in the message callbacks for each message, in
+         * microseconds
+         */
+        Log2Histogram callback_time_us;
+
+        /** Bytes queued by libdatachannel and not yet sent, at snapshot time */
+        uint64_t send_buffered_bytes = 0;
+        /** Highest value of send_buffered_bytes seen after a send */
+        uint64_t max_send_buffered_bytes = 0;
+        /** Frames waiting in the dispatch queue, if the dispatch thread is used */
+        uint64_t dispatch_queue_depth = 0;
+        uint64_t max_dispatch_queue_depth = 0;
+
+        uint64_t open_count = 0;
+        uint64_t close_count = 0;
+        /** Number of times the connection was lost, see
+         * SynchronousWebSocket::enableAutoReconnect
+         */
+        uint64_t disconnect_count = 0;
+        base::Time last_open_duration;
+        base::Time last_close_duration;
+
+        /** One-line human-readable summary, meant to be logged periodically */
+        std::string toString() const;
+    };
+
+    /** The counters behind WebSocketMetricsSnapshot
+     *
+     * All the record* methods use relaxed atomics only, and can be called from
+     * any thread. They are cheap enough to be always enabled.
+     */
+    class WebSocketMetrics {
+    public:
+        /** Record a sent frame, which may carry several coalesced messages */
+        void recordSent(size_t bytes, size_t messages, size_t buffered_bytes);
+        void recordFrame(size_t bytes, size_t records);
+        void recordParse(uint64_t duration_us, bool success);
+        void recordCallbacks(uint64_t duration_us);
+        void recordOpen(base::Time const& duration);
+        void recordClose(base::Time const& duration);
+        /** Record the loss of the connection, as opposed to a requested close */
+        void recordDisconnect();
+
+        /** The current values of the counters
+         *
+         * The fields that depend on the websocket state (buffered bytes,
+         * dispatch queue) are left to the caller
+         */
+        WebSocketMetricsSnapshot snapshot() const;
+        void reset();
+
+    private:
+        std::atomic<uint64_t> m_sent_frames{0};
+        std::atomic<uint64_t> m_sent_messages{0};
+        std::atomic<uint64_t> m_sent_bytes{0};
+        std::atomic<uint64_t> m_received_frames{0};
+        std::atomic<uint64_t> m_received_messages{0};
+        std::atomic<uint64_t> m_received_bytes{0};
+        std::atomic<uint64_t> m_json_errors{0};
+        AtomicLog2Histogram m_records_per_frame;
+        AtomicLog2Histogram m_parse_time_us;
+        AtomicLog2Histogram m_callback_time_us;
+        std::atomic<uint64_t> m_max_send_buffered_bytes{0};
+        std::atomic<uint64_t> m_open_count{0};
+        std::atomic<uint64_t> m_close_count{0};
+        std::atomic<uint64_t> m_disconnect_count{0};
+        std::atomic<int64_t> m_last_open_duration_us{0};
+        std::atomic<int64_t> m_last_close_duration_us{0};
+    };
+}
+
+#endif
@@ -0,0 +1,106 @@
+#include "ZoomCameraCommandBatcher.hpp"
+#include "CommandAndStateMessageParser.hpp"
+
+using namespace std;
+using namespace base;
+using namespace deep_trekker;
+
+ZoomCameraCommandBatcher::ZoomCameraCommandBatcher(string const& api_version,
+    string const& address,
+    int model,
+    string const& camera_id,
+    Time const& zoom_speed_period)
+    : m_api_version(api_version)
+    , m_address(address)
+    , m_model(model)
+    , m_camera_id(camera_id)
+    , m_zoom_speed_period(zoom_speed_period)
+{
+}
+
+uint32_t ZoomCameraCommandBatcher::changedSettings(
+    array<double, SETTING_COUNT> const& encoded) const
+{
+    uint32_t changed = 0;
+    for (int i = 0; i < SETTING_COUNT; ++i) {
+        uint32_t setting = 1 << i;
+        if (!(m_sent_settings & setting) || m_sent[i] != encoded[i]) {
+            changed |= setting;
+        }
+    }
+    return changed;
+}
+
+string const& ZoomCameraCommandBatcher::update(
+    TamronHarrierZoomCameraCommand const& command,
+    Time const& now)
+{
+    m_requested = command;
+    m_has_requested = true;
+    return poll(now);
+}
+
+string const& ZoomCameraCommandBatcher::poll(Time const& now)
+{
+    m_message.clear();
+    m_last_sent_settings = 0;
+    if (!m_has_requested) {
+        return m_message;
+    }
+
+    auto encoded = CommandAndStateMessageParser::encodeZoomCamera(m_requested);
+    uint32_t changed = changedSettings(encoded);
+    if (changed & ZOOM_CAMERA_ZOOM_SPEED) {
+        bool stop = encoded[SETTING_COUNT - 1] == 0;
+        bool due = m_last_zoom_speed_time.isNull() ||
+                   now - m_last_zoom_speed_time >= m_zoom_speed_period;
+        if (!stop && !due) {
+            changed &= ~ZOOM_CAMERA_ZOOM_SPEED;
+        }
+    }
+    if (!changed) {
+        return m_message;
+    }
+
+    auto message = CommandAndStateMessageParser::payloadSetMessageTemplate(m_api_version,
+        m_address,
+        m_model);
+    auto& device = message["payload"]["devices"][m_address];
+    CommandAndStateMessageParser::writeZoomCamera(device,
+        m_camera_id,
+        m_requested,
+        changed);
+    Json::FastWriter fast;
+    m_message = fast.write(message);
+
+    for (int i = 0; i < SETTING_COUNT; ++i) {
+        if (changed & (1 << i)) {
+            m_sent[i] = encoded[i];
+        }
+    }
+    m_sent_settings |= changed;
+    m_last_sent_settings = changed;
+    if (changed & ZOOM_CAMERA_ZOOM_SPEED) {
+        m_last_zoom_speed_time = now;
+    }
+    return m_message;
+}
+
+bool ZoomCameraCommandBatcher::hasPendingZoomSpeed() const
+{
+    return m_has_requested &&
+           (changedSettings(CommandAndStateMessageParser::encodeZoomCamera(m_requested)) &
+               ZOOM_CAMERA_ZOOM_SPEED);
+}
+
+uint32_t ZoomCameraCommandBatcher::getLastSentSettings() const
+{
+    return m_last_sent_settings;
+}
+
+void ZoomCameraCommandBatcher::reset()
+{
+    m_sent_settings = 0;
+    m_last_sent_settings = 0;
+    m_last_zoom_speed_time = Time();
+}
@@ -0,0 +1,88 @@
+#ifndef _DEEP_TREKKER_ZOOM_CAMERA_COMMAND_BATCHER_HPP_
+#define _DEEP_TREKKER_ZOOM_CAMERA_COMMAND_BATCHER_HPP_
+
+#include "base/Time.hpp"
+#include "deep_trekker/DeepTrekkerCommands.hpp"
+#include <array>
+#include <cstdint>
+#include <string>
+
+namespace deep_trekker {
+    /** Turns the commands of a Tamron Harrier zoom camera into SET messages that
+     * only carry the settings that changed
+     *
+     * Every setting whose encoded value differs from the last one sent is packed
+     * in a single message. The zoom speed, which is usually streamed from a
+     * joystick, is additionally rate-limited: a new speed is sent at most once
+     * per zoom speed period, the latest one being held back in between. Stopping
+     * the zoom (a zero speed) is never held back.
+     */
+    class ZoomCameraCommandBatcher {
+    public:
+        /**
+         * @param zoom_speed_period minimum time between two messages that change
+         *   the zoom speed. Zero disables the rate limit
+         */
+        ZoomCameraCommandBatcher(std::string const& api_version,
+            std::string const& address,
+            int model,
+            std::string const& camera_id,
+            base::Time const& zoom_speed_period);
+
+        /** Set the desired camera settings
+         *
+         * @return the SET message to send, or an empty string if nothing changed
+         *   or if the only change is a zoom speed held back by the rate limit. The
+         *   string is valid until the next call to update or poll
+         */
+        std::string const& update(TamronHarrierZoomCameraCommand const& command,
+            base::Time const& now);
+
+        /** Send the zoom speed held back by the rate limit, if it is now due
+         *
+         * Call it periodically, so that the last speed set by update is sent even
+         * if update is not called anymore
+         *
+         * @return the SET message to send, or an empty string
+         */
+        std::string const& poll(base::Time const& now);
+
+        /** Whether a zoom speed is being held back by the rate limit */
+        bool hasPendingZoomSpeed() const;
+
+        /** The TamronHarrierZoomCameraSetting values carried by the last message
+         * returned by update or poll
+         */
+        uint32_t getLastSentSettings() const;
+
+        /** Forget the settings sent so far, so that the next update sends all of
+         * them
+         *
+         * Call it after reconnecting to the vehicle
+         */
+        void reset();
+
+    private:
+        static const int SETTING_COUNT = ZOOM_CAMERA_SETTING_COUNT;
+
+        std::string m_api_version;
+        std::string m_address;
+        int m_model;
+        std::string m_camera_id;
+        base::Time m_zoom_speed_period;
+
+        TamronHarrierZoomCameraCommand m_requested{};
+        bool m_has_requested = false;
+        /** The encoded values of the last sent settings, in bit order */
+        std::array<double, SETTING_COUNT> m_sent{};
+        /** The settings that have been sent at least once since the last reset */
+        uint32_t m_sent_settings = 0;
+        uint32_t m_last_sent_settings = 0;
+        base::Time m_last_zoom_speed_time;
+        std::string m_message;
+
+        uint32_t changedSettings(std::array<double, SETTING_COUNT> const& encoded) const;
+    };
+}
+
+#endif
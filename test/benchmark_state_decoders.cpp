@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <chrono>
+#include <deep_trekker/CommandAndStateMessageParser.hpp>
+#include <fstream>
+#include <iostream>
+
+using namespace std;
+using namespace deep_trekker;
+
+/** Compare the DOM and streaming decoders of CommandAndStateMessageParser
+ *
+ * Usage: benchmark_state_decoders [MESSAGES_FILE [ITERATIONS]]
+ *
+ * MESSAGES_FILE contains one recorded DT API message per line. If not given, a
+ * synthetic message with the states of a revolution is used instead.
+ */
+
+static string syntheticMessage()
+{
+    return "{\"apiVersion\":\"0.20.0\",\"method\":\"GET\",\"payload\":{\"devices\":{"
+           "\"rev\":{\"model\":13,\"depth\":12.5,\"roll\":2.0,\"pitch\":-4.0,"
+           "\"heading\":270.0,\"cpuTemp\":51,\"leak\":false,"
+           "\"usageTime\":{\"currentSeconds\":3600},\"auxLight\":{\"intensity\":25},"
+           "\"drive\":{\"thrust\":{\"forward\":10,\"lateral\":-20,\"vertical\":30,"
+           "\"yaw\":0},\"modes\":{\"autoStabilization\":true,\"motorsDisabled\":false,"
+           "\"altitudeLock\":false,\"depthLock\":true,\"headingLock\":false}},"
+           "\"frontRightMotorDiagnostics\":{\"pwm\":10,\"current\":100,\"rpm\":1000,"
+           "\"overcurrent\":false},"
+           "\"frontLeftMotorDiagnostics\":{\"pwm\":10,\"current\":100,\"rpm\":1000,"
+           "\"overcurrent\":false},"
+           "\"rearRightMotorDiagnostics\":{\"pwm\":10,\"current\":100,\"rpm\":1000,"
+           "\"overcurrent\":false},"
+           "\"rearLeftMotorDiagnostics\":{\"pwm\":10,\"current\":100,\"rpm\":1000,"
+           "\"overcurrent\":false},"
+           "\"verticalRightMotorDiagnostics\":{\"pwm\":10,\"current\":100,\"rpm\":1000,"
+           "\"overcurrent\":false},"
+           "\"verticalLeftMotorDiagnostics\":{\"pwm\":10,\"current\":100,\"rpm\":1000,"
+           "\"overcurrent\":false},"
+           "\"cameraHead\":{\"light\":{\"intensity\":40},\"lasers\":{\"enabled\":true},"
+           "\"leak\":false,\"tilt\":{\"position\":30},\"tiltMotorDiagnostics\":{"
+           "\"overcurrent\":false,\"rpm\":20,\"pwm\":80,\"current\":60}}}}}}";
+}
+
+static double benchmark(CommandAndStateMessageParser::DecodeMode mode,
+    vector<string> const& messages,
+    int iterations,
+    vector<string> const& addresses)
+{
+    CommandAndStateMessageParser parser;
+    parser.setDecodeMode(mode);
+
+    string errors;
+    uint32_t checksum = 0;
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        for (auto const& msg : messages) {
+            parser.parseJSONMessage(msg, errors);
+            for (auto const& address : addresses) {
+                checksum += parser.decodeSnapshot(address).field_groups;
+            }
+        }
+    }
+    auto duration = chrono::steady_clock::now() - start;
+    if (checksum == 0) {
+        cerr << "warning: no field group decoded, check the device addresses" << endl;
+    }
+
+    return chrono::duration<double, nano>(duration).count() /
+           (iterations * messages.size());
+}
+
+int main(int argc, char** argv)
+{
+    vector<string> messages;
+    if (argc > 1) {
+        ifstream file(argv[1]);
+        string line;
+        while (getline(file, line)) {
+            if (!line.empty()) {
+                messages.push_back(line);
+            }
+        }
+    }
+    else {
+        messages.push_back(syntheticMessage());
+    }
+    int iterations = argc > 2 ? stoi(argv[2]) : 100000 / messages.size() + 1;
+
+    // Decode all the devices present in the messages
+    vector<string> addresses;
+    CommandAndStateMessageParser parser;
+    string errors;
+    for (auto const& msg : messages) {
+        parser.parseJSONMessage(msg, errors);
+        auto devices = parser.getJson()["payload"]["devices"];
+        for (auto const& address : devices.getMemberNames()) {
+            if (find(addresses.begin(), addresses.end(), address) == addresses.end()) {
+                addresses.push_back(address);
+            }
+        }
+    }
+
+    double dom = benchmark(CommandAndStateMessageParser::DECODE_DOM,
+        messages,
+        iterations,
+        addresses);
+    double streaming = benchmark(CommandAndStateMessageParser::DECODE_STREAMING,
+        messages,
+        iterations,
+        addresses);
+
+    cout << messages.size() << " messages, " << addresses.size() << " devices, "
+         << iterations << " iterations" << endl;
+    cout << "DOM:       " << dom << " ns/message" << endl;
+    cout << "streaming: " << streaming << " ns/message" << endl;
+    return 0;
+}
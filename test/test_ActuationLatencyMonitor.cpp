@@ -0,0 +1,145 @@
+#include <deep_trekker/ActuationLatencyMonitor.hpp>
+#include <gtest/gtest.h>
+
+using namespace std;
+using namespace base;
+using namespace deep_trekker;
+
+struct ActuationLatencyMonitorTest : public ::testing::Test {
+    ActuationLatencyMonitor monitor{Time::fromMilliseconds(10), 10, Time::fromSeconds(1)};
+    Time start = Time::now();
+
+    DeviceSnapshot lightSnapshot(double light, Time const& time)
+    {
+        DeviceSnapshot snapshot;
+        snapshot.time = time;
+        snapshot.field_groups = FIELD_GROUP_CAMERA_HEAD | FIELD_GROUP_AUX_LIGHT;
+        snapshot.revolution.camera_head.light = light;
+        snapshot.revolution.aux_light = light;
+        return snapshot;
+    }
+};
+
+TEST_F(ActuationLatencyMonitorTest, it_measures_the_time_until_the_state_matches)
+{
+    monitor.commandSentCameraHeadLight(0.5, start);
+    monitor.update(lightSnapshot(0.2, start + Time::fromMilliseconds(10)));
+    auto light = ActuationLatencyMonitor::ACTUATOR_CAMERA_HEAD_LIGHT;
+    ASSERT_TRUE(monitor.isMeasuring(light));
+    monitor.update(lightSnapshot(0.5, start + Time::fromMilliseconds(35)));
+    ASSERT_FALSE(monitor.isMeasuring(light));
+
+    auto const& histogram = monitor.getHistogram(light);
+    ASSERT_EQ(1, histogram.count);
+    ASSERT_EQ(1, histogram.bins[3]);
+    ASSERT_EQ(Time::fromMilliseconds(35), histogram.last);
+    ASSERT_EQ(Time::fromMilliseconds(40), histogram.quantile(0.5));
+}
+
+TEST_F(ActuationLatencyMonitorTest, it_does_not_restart_on_unchanged_commands)
+{
+    monitor.commandSentAuxLight(0.5, start);
+    monitor.commandSentAuxLight(0.501, start + Time::fromMilliseconds(20));
+    monitor.update(lightSnapshot(0.5, start + Time::fromMilliseconds(50)));
+    auto const& histogram =
+        monitor.getHistogram(ActuationLatencyMonitor::ACTUATOR_AUX_LIGHT);
+    ASSERT_EQ(Time::fromMilliseconds(50), histogram.last);
+}
+
+TEST_F(ActuationLatencyMonitorTest, it_counts_commands_that_are_never_reported)
+{
+    monitor.commandSentAuxLight(0.5, start);
+    monitor.update(lightSnapshot(0.2, start + Time::fromMilliseconds(1500)));
+    auto const& histogram =
+        monitor.getHistogram(ActuationLatencyMonitor::ACTUATOR_AUX_LIGHT);
+    ASSERT_EQ(0, histogram.count);
+    ASSERT_EQ(1, histogram.timeouts);
+}
+
+TEST_F(ActuationLatencyMonitorTest, it_times_out_actuators_absent_from_the_states)
+{
+    monitor.commandSentDrive(commands::LinearAngular6DCommand(), start);
+    monitor.update(lightSnapshot(0.2, start + Time::fromMilliseconds(500)));
+    auto drive = ActuationLatencyMonitor::ACTUATOR_DRIVE;
+    ASSERT_TRUE(monitor.isMeasuring(drive));
+    monitor.update(lightSnapshot(0.2, start + Time::fromMilliseconds(1500)));
+    ASSERT_FALSE(monitor.isMeasuring(drive));
+    ASSERT_EQ(1, monitor.getHistogram(drive).timeouts);
+}
+
+TEST_F(ActuationLatencyMonitorTest, it_expires_commands_without_any_state)
+{
+    monitor.commandSentAuxLight(0.5, start);
+    auto aux_light = ActuationLatencyMonitor::ACTUATOR_AUX_LIGHT;
+    monitor.expire(start + Time::fromMilliseconds(500));
+    ASSERT_TRUE(monitor.isMeasuring(aux_light));
+    monitor.expire(start + Time::fromMilliseconds(1500));
+    ASSERT_FALSE(monitor.isMeasuring(aux_light));
+    ASSERT_EQ(1, monitor.getHistogram(aux_light).timeouts);
+}
+
+TEST_F(ActuationLatencyMonitorTest, it_counts_replaced_commands_separately)
+{
+    monitor.commandSentAuxLight(0.5, start);
+    monitor.commandSentAuxLight(0.8, start + Time::fromMilliseconds(20));
+    monitor.update(lightSnapshot(0.8, start + Time::fromMilliseconds(50)));
+    auto const& histogram =
+        monitor.getHistogram(ActuationLatencyMonitor::ACTUATOR_AUX_LIGHT);
+    ASSERT_EQ(1, histogram.replaced);
+    ASSERT_EQ(0, histogram.timeouts);
+    ASSERT_EQ(1, histogram.count);
+    ASSERT_EQ(Time::fromMilliseconds(30), histogram.last);
+}
+
+TEST_F(ActuationLatencyMonitorTest, it_clears_the_histograms_on_reset)
+{
+    monitor.commandSentAuxLight(0.5, start);
+    monitor.commandSentAuxLight(0.8, start + Time::fromMilliseconds(20));
+    monitor.update(lightSnapshot(0.8, start + Time::fromMilliseconds(50)));
+    monitor.reset();
+
+    auto const& histogram =
+        monitor.getHistogram(ActuationLatencyMonitor::ACTUATOR_AUX_LIGHT);
+    ASSERT_EQ(0, histogram.count);
+    ASSERT_EQ(0, histogram.replaced);
+    ASSERT_EQ(10, histogram.bins.size());
+    ASSERT_EQ(0, histogram.bins[3]);
+    ASSERT_EQ(Time::fromMilliseconds(10), histogram.bin_width);
+    ASSERT_EQ(Time(), histogram.quantile(0.5));
+}
+
+TEST_F(ActuationLatencyMonitorTest, it_matches_the_drive_thrust_echo)
+{
+    commands::LinearAngular6DCommand command;
+    command.linear = Eigen::Vector3d(0.5, -0.2, 0.1);
+    command.angular = Eigen::Vector3d(0, 0, 0.3);
+    monitor.commandSentDrive(command, start);
+
+    DeviceSnapshot snapshot;
+    snapshot.time = start + Time::fromMilliseconds(120);
+    snapshot.field_groups = FIELD_GROUP_DRIVE_THRUST;
+    snapshot.revolution.drive_setpoint.position = Eigen::Vector3d(50, -20, 10);
+    snapshot.revolution.drive_setpoint.orientation =
+        Eigen::Quaterniond(Eigen::AngleAxisd(30, Eigen::Vector3d::UnitZ()));
+    monitor.update(snapshot);
+
+    auto const& histogram = monitor.getHistogram(ActuationLatencyMonitor::ACTUATOR_DRIVE);
+    ASSERT_EQ(1, histogram.count);
+    ASSERT_EQ(1, histogram.overflow);
+}
+
+TEST_F(ActuationLatencyMonitorTest, it_matches_the_tilt_on_the_motor_activity)
+{
+    monitor.commandSentCameraHeadTilt(0.5, start);
+
+    DeviceSnapshot snapshot = lightSnapshot(0, start + Time::fromMilliseconds(10));
+    snapshot.revolution.camera_head.motor_states.elements.resize(1);
+    snapshot.revolution.camera_head.motor_states.elements[0].raw = 0;
+    monitor.update(snapshot);
+    ASSERT_TRUE(monitor.isMeasuring(ActuationLatencyMonitor::ACTUATOR_CAMERA_HEAD_TILT));
+
+    snapshot.time = start + Time::fromMilliseconds(20);
+    snapshot.revolution.camera_head.motor_states.elements[0].raw = 0.4;
+    monitor.update(snapshot);
+    ASSERT_FALSE(monitor.isMeasuring(ActuationLatencyMonitor::ACTUATOR_CAMERA_HEAD_TILT));
+}
@@ -0,0 +1,91 @@
+#include <deep_trekker/BoundedQueue.hpp>
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+
+using namespace std;
+using namespace deep_trekker;
+
+TEST(BoundedQueueTest, it_rounds_the_capacity_up_to_a_power_of_two)
+{
+    ASSERT_EQ(2, BoundedQueue<int>(1).capacity());
+    ASSERT_EQ(2, BoundedQueue<int>(2).capacity());
+    ASSERT_EQ(8, BoundedQueue<int>(5).capacity());
+    ASSERT_EQ(8, BoundedQueue<int>(8).capacity());
+    ASSERT_THROW(BoundedQueue<int>(0), invalid_argument);
+}
+
+TEST(BoundedQueueTest, it_keeps_its_elements_at_the_smallest_capacity)
+{
+    BoundedQueue<int> queue(1);
+    for (int round = 0; round < 3; ++round) {
+        int first = 1, second = 2, third = 3;
+        ASSERT_TRUE(queue.tryPush(first));
+        ASSERT_TRUE(queue.tryPush(second));
+        ASSERT_FALSE(queue.tryPush(third));
+        ASSERT_EQ(2, queue.size());
+
+        int value = 0;
+        ASSERT_TRUE(queue.tryPop(value));
+        ASSERT_EQ(1, value);
+        ASSERT_TRUE(queue.tryPop(value));
+        ASSERT_EQ(2, value);
+        ASSERT_FALSE(queue.tryPop(value));
+        ASSERT_TRUE(queue.empty());
+    }
+}
+
+TEST(BoundedQueueTest, it_pops_the_elements_in_push_order)
+{
+    BoundedQueue<string> queue(4);
+    for (string value : {"a", "b", "c", "d"}) {
+        ASSERT_TRUE(queue.tryPush(value));
+        ASSERT_TRUE(value.empty());
+    }
+    ASSERT_EQ(4, queue.size());
+
+    string value = "e";
+    ASSERT_FALSE(queue.tryPush(value));
+    ASSERT_EQ("e", value);
+
+    for (string expected : {"a", "b", "c", "d"}) {
+        ASSERT_TRUE(queue.tryPop(value));
+        ASSERT_EQ(expected, value);
+    }
+    ASSERT_FALSE(queue.tryPop(value));
+    ASSERT_TRUE(queue.empty());
+}
+
+TEST(BoundedQueueTest, it_wraps_around)
+{
+    BoundedQueue<int> queue(2);
+    for (int i = 0; i < 10; ++i) {
+        int value = i;
+        ASSERT_TRUE(queue.tryPush(value));
+        ASSERT_TRUE(queue.tryPop(value));
+        ASSERT_EQ(i, value);
+    }
+}
+
+TEST(BoundedQueueTest, it_transfers_all_elements_between_two_threads_in_order)
+{
+    BoundedQueue<int> queue(16);
+    const int count = 100000;
+    thread producer([&queue] {
+        for (int i = 0; i < count; ++i) {
+            int value = i;
+            while (!queue.tryPush(value)) {
+                this_thread::yield();
+            }
+        }
+    });
+
+    for (int expected = 0; expected < count;) {
+        int value;
+        if (queue.tryPop(value)) {
+            ASSERT_EQ(expected, value);
+            ++expected;
+        }
+    }
+    producer.join();
+}
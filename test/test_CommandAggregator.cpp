@@ -0,0 +1,100 @@
+#include <deep_trekker/CommandAggregator.hpp>
+#include <deep_trekker/CommandAndStateMessageParser.hpp>
+#include <gtest/gtest.h>
+
+using namespace std;
+using namespace base;
+using namespace deep_trekker;
+
+struct CommandAggregatorTest : public ::testing::Test {
+    string api_version = "12.0.2";
+    CommandAndStateMessageParser parser;
+
+    static Json::Value parse(string const& message)
+    {
+        Json::Value json;
+        Json::CharReaderBuilder builder;
+        unique_ptr<Json::CharReader> reader(builder.newCharReader());
+        reader->parse(message.data(), message.data() + message.size(), &json, nullptr);
+        return json;
+    }
+};
+
+TEST_F(CommandAggregatorTest, it_combines_the_commands_of_a_device_in_one_message)
+{
+    commands::LinearAngular6DCommand drive;
+    drive.linear = Eigen::Vector3d(0.1, 0.2, 0.3);
+    drive.angular = Eigen::Vector3d(0, 0, 0.4);
+    auto tilt = samples::Joints::Speeds(vector<float>{0.5});
+
+    CommandAggregator aggregator(api_version);
+    aggregator.setAuxLight("rev", 13, 0.1);
+    aggregator.setDrive("rev", 13, drive);
+    aggregator.setCameraHeadTilt("rev", 13, 102, tilt);
+    aggregator.setAuxLight("rev", 13, 0.6);
+    auto messages = aggregator.flush();
+    ASSERT_EQ(1, messages.size());
+    ASSERT_FALSE(aggregator.hasPendingCommands());
+
+    auto expected = parse(
+        parser.parseDriveRevolutionCommandMessage(api_version, "rev", 13, drive));
+    auto& device = expected["payload"]["devices"]["rev"];
+    device["cameraHead"] = parse(parser.parseTiltCameraHeadCommandMessage(api_version,
+        "rev",
+        13,
+        102,
+        tilt))["payload"]["devices"]["rev"]["cameraHead"];
+    device["auxLight"] = parse(parser.parseAuxLightCommandMessage(api_version,
+        "rev",
+        13,
+        0.6))["payload"]["devices"]["rev"]["auxLight"];
+    ASSERT_EQ(expected, parse(messages[0]));
+}
+
+TEST_F(CommandAggregatorTest, it_generates_one_message_per_device)
+{
+    CommandAggregator aggregator(api_version);
+    aggregator.setAuxLight("rev", 13, 0.1);
+    aggregator.setPoweredReel("reel", 12, samples::Joints::Speeds(vector<float>{0.5}));
+    auto messages = aggregator.flush();
+    ASSERT_EQ(2, messages.size());
+    ASSERT_EQ(parser.parsePoweredReelCommandMessage(api_version,
+                  "reel",
+                  12,
+                  samples::Joints::Speeds(vector<float>{0.5})),
+        messages[0]);
+    ASSERT_EQ(parser.parseAuxLightCommandMessage(api_version, "rev", 13, 0.1),
+        messages[1]);
+}
+
+TEST_F(CommandAggregatorTest, it_flushes_at_the_configured_period)
+{
+    CommandAggregator aggregator(api_version, Time::fromMilliseconds(100));
+    auto start = Time::now();
+    aggregator.setAuxLight("rev", 13, 0.1);
+    ASSERT_EQ(1, aggregator.flushIfDue(start).size());
+
+    aggregator.setAuxLight("rev", 13, 0.2);
+    ASSERT_TRUE(aggregator.flushIfDue(start + Time::fromMilliseconds(50)).empty());
+    ASSERT_TRUE(aggregator.hasPendingCommands());
+    auto messages = aggregator.flushIfDue(start + Time::fromMilliseconds(100));
+    ASSERT_EQ(1, messages.size());
+    ASSERT_EQ(parser.parseAuxLightCommandMessage(api_version, "rev", 13, 0.2),
+        messages[0]);
+}
+
+TEST_F(CommandAggregatorTest, it_sends_a_command_set_after_an_empty_flush_right_away)
+{
+    CommandAggregator aggregator(api_version, Time::fromMilliseconds(100));
+    auto start = Time::now();
+    ASSERT_TRUE(aggregator.flushIfDue(start).empty());
+
+    aggregator.setAuxLight("rev", 13, 0.1);
+    auto messages = aggregator.flushIfDue(start + Time::fromMilliseconds(10));
+    ASSERT_EQ(1, messages.size());
+    ASSERT_EQ(parser.parseAuxLightCommandMessage(api_version, "rev", 13, 0.1),
+        messages[0]);
+
+    aggregator.setAuxLight("rev", 13, 0.2);
+    ASSERT_TRUE(aggregator.flushIfDue(start + Time::fromMilliseconds(20)).empty());
+}
@@ -327,6 +327,54 @@ TEST_F(MessageParserTest, it_throws_an_invalid_argument_error_when_the_field_isn
     ASSERT_ANY_THROW(parser.getCameras("revolution_id123"));
 }
 
+TEST_F(MessageParserTest, it_throws_an_invalid_argument_error_on_a_field_of_invalid_type)
+{
+    auto parser = getMessageParser();
+    Json::Value pose_info;
+    pose_info["payload"]["devices"]["revolution_id123"]["model"] = 13;
+    pose_info["payload"]["devices"]["revolution_id123"]["depth"] = Json::Value();
+    pose_info["payload"]["devices"]["revolution_id123"]["roll"] = 20.0;
+    pose_info["payload"]["devices"]["revolution_id123"]["pitch"] = 10.0;
+    pose_info["payload"]["devices"]["revolution_id123"]["heading"] = 90.0;
+    pose_info["payload"]["devices"]["revolution_id123"]["cpuTemp"] = "hot";
+    Json::FastWriter writer;
+    string errors;
+    parser.parseJSONMessage(writer.write(pose_info).c_str(), errors);
+
+    ASSERT_THROW(parser.getRevolutionPoseZAttitude("revolution_id123"),
+        invalid_argument);
+    ASSERT_THROW(parser.getCpuTemperature("revolution_id123"), invalid_argument);
+}
+
+TEST_F(MessageParserTest, it_rejects_battery_and_overcurrent_states_of_invalid_type)
+{
+    auto parser = getMessageParser();
+    Json::Value msg;
+    Json::Value& reel = msg["payload"]["devices"]["reel_id123"];
+    reel["model"] = 108;
+    reel["battery1"]["percent"] = "x";
+    reel["battery1"]["voltage"] = 24;
+    reel["battery3"]["percent"] = "x";
+    reel["battery3"]["voltage"] = 24;
+    reel["battery4"]["percent"] = 50;
+    reel["battery4"]["voltage"] = 24;
+    reel["motor1Diagnostics"]["overcurrent"] = "x";
+    reel["motor3Diagnostics"]["overcurrent"] = "x";
+    reel["motor4Diagnostics"]["overcurrent"] = true;
+    Json::FastWriter writer;
+    string errors;
+    parser.parseJSONMessage(writer.write(msg).c_str(), errors);
+
+    ASSERT_THROW(parser.getBatteryStates("reel_id123", "battery1"), invalid_argument);
+    ASSERT_THROW(parser.getBatteryStates("reel_id123", "battery3"), invalid_argument);
+    ASSERT_NEAR(0.5, parser.getBatteryStates("reel_id123", "battery4").charge, 1e-6);
+    ASSERT_THROW(parser.getMotorOvercurrentStates("reel_id123", "motor1Diagnostics"),
+        invalid_argument);
+    ASSERT_THROW(parser.getMotorOvercurrentStates("reel_id123", "motor3Diagnostics"),
+        invalid_argument);
+    ASSERT_TRUE(parser.getMotorOvercurrentStates("reel_id123", "motor4Diagnostics"));
+}
+
 TEST_F(MessageParserTest, it_returns_the_rov_pose_with_z_and_attitude)
 {
     auto parser = getMessageParser();
@@ -709,9 +757,9 @@ TEST_F(MessageParserTest, it_creates_a_get_request_for_the_camera_head_states)
     expected_json["payload"]["devices"]["abcd"]["cameraHead"]["light"]["intensity"] = 0;
     expected_json["payload"]["devices"]["abcd"]["cameraHead"]["lasers"]["enabled"] =
         false;
-    expected_json["payload"]["devices"]["abcd"]["cameraHead"]["leak"] = true;
+    expected_json["payload"]["devices"]["abcd"]["cameraHead"]["leak"] = false;
     expected_json["payload"]["devices"]["abcd"]["cameraHead"]["tiltMotorDiagnostics"]
-                 ["overcurrent"] = true;
+                 ["overcurrent"] = false;
     expected_json["payload"]["devices"]["abcd"]["cameraHead"]["tiltMotorDiagnostics"]
                  ["pwm"] = 0;
     expected_json["payload"]["devices"]["abcd"]["cameraHead"]["tiltMotorDiagnostics"]
@@ -763,3 +811,634 @@ TEST_F(MessageParserTest,
     camera_head_tilt = parser.computeCameraHead2BodyTilt("revolution_id123");
     ASSERT_EQ(camera_head_tilt, base::Angle::fromDeg(90));
 }
+
+TEST_F(MessageParserTest, it_decodes_the_field_groups_present_in_a_device_snapshot)
+{
+    auto parser = getMessageParser();
+    Json::Value root;
+    root["payload"]["devices"]["revolution_id123"]["model"] = 13;
+    root["payload"]["devices"]["revolution_id123"]["depth"] = 20;
+    root["payload"]["devices"]["revolution_id123"]["roll"] = 0.0;
+    root["payload"]["devices"]["revolution_id123"]["pitch"] = 10.0;
+    root["payload"]["devices"]["revolution_id123"]["heading"] = 90.0;
+    root["payload"]["devices"]["revolution_id123"]["auxLight"]["intensity"] = 30;
+    root["payload"]["devices"]["revolution_id123"]["drive"]["thrust"]["forward"] = 10;
+
+    Json::FastWriter writer;
+    string errors;
+    parser.parseJSONMessage(writer.write(root).c_str(), errors);
+    auto const& snapshot = parser.decodeSnapshot("revolution_id123");
+
+    ASSERT_EQ(FIELD_GROUP_MODEL | FIELD_GROUP_POSE | FIELD_GROUP_AUX_LIGHT,
+        snapshot.field_groups);
+    ASSERT_EQ(DEVICE_MODEL_REVOLUTION, snapshot.model);
+    ASSERT_NEAR(-20, snapshot.revolution.pose.position.z(), 1e-6);
+    ASSERT_NEAR(0.3, snapshot.revolution.aux_light, 1e-6);
+    ASSERT_EQ(snapshot.time, snapshot.revolution.pose.time);
+    ASSERT_ANY_THROW(parser.getRevolutionDriveStates("revolution_id123"));
+}
+
+TEST_F(MessageParserTest, it_decodes_a_powered_reel_snapshot)
+{
+    auto parser = getMessageParser();
+    Json::Value root;
+    auto& reel = root["payload"]["devices"]["reel_id123"];
+    reel["model"] = 108;
+    reel["distance"] = 1250;
+    reel["leak"] = false;
+    reel["cpuTemp"] = 42;
+    reel["battery1"]["percent"] = 80;
+    reel["battery1"]["voltage"] = 24;
+    reel["battery2"]["percent"] = 60;
+    reel["battery2"]["voltage"] = 23;
+    reel["acConnected"] = true;
+    reel["eStop"] = false;
+    reel["motor1Diagnostics"]["overcurrent"] = true;
+    reel["motor1Diagnostics"]["current"] = 40;
+    reel["motor1Diagnostics"]["pwm"] = 40;
+    reel["motor2Diagnostics"]["overcurrent"] = false;
+    reel["motor2Diagnostics"]["current"] = 42;
+    reel["motor2Diagnostics"]["pwm"] = 42;
+
+    Json::FastWriter writer;
+    string errors;
+    parser.parseJSONMessage(writer.write(root).c_str(), errors);
+    auto const& snapshot = parser.decodeSnapshot("reel_id123").powered_reel;
+
+    ASSERT_NEAR(12.5, snapshot.tether_length, 1e-6);
+    ASSERT_FALSE(snapshot.leak);
+    ASSERT_NEAR(42, snapshot.cpu_temperature, 1e-6);
+    ASSERT_NEAR(0.8, snapshot.battery_1.charge, 1e-6);
+    ASSERT_NEAR(23, snapshot.battery_2.voltage, 1e-6);
+    ASSERT_TRUE(snapshot.ac_power_connected);
+    ASSERT_FALSE(snapshot.estop_enabled);
+    ASSERT_TRUE(snapshot.motor_1_overcurrent);
+    ASSERT_FALSE(snapshot.motor_2_overcurrent);
+    ASSERT_EQ(2, snapshot.motor_states.elements.size());
+    ASSERT_NEAR(0.42, snapshot.motor_states.elements[1].raw, 1e-6);
+
+    ASSERT_NEAR(0.6, parser.getBatteryStates("reel_id123", "battery2").charge, 1e-6);
+    ASSERT_TRUE(parser.getMotorOvercurrentStates("reel_id123", "motor1Diagnostics"));
+}
+
+TEST_F(MessageParserTest, it_decodes_the_snapshot_again_after_a_new_message_is_parsed)
+{
+    auto parser = getMessageParser();
+    Json::Value root;
+    root["payload"]["devices"]["revolution_id123"]["leak"] = false;
+
+    Json::FastWriter writer;
+    string errors;
+    parser.parseJSONMessage(writer.write(root).c_str(), errors);
+    ASSERT_FALSE(parser.isLeaking("revolution_id123"));
+
+    root["payload"]["devices"]["revolution_id123"]["leak"] = true;
+    parser.parseJSONMessage(writer.write(root).c_str(), errors);
+    ASSERT_TRUE(parser.isLeaking("revolution_id123"));
+}
+
+TEST_F(MessageParserTest, it_returns_the_grabber_motor_states)
+{
+    auto parser = getMessageParser();
+    Json::Value root;
+    auto& grabber = root["payload"]["devices"]["revolution_id123"]["grabber"];
+    grabber["openCloseMotorDiagnostics"]["overcurrent"] = true;
+    grabber["openCloseMotorDiagnostics"]["current"] = 10;
+    grabber["openCloseMotorDiagnostics"]["pwm"] = 20;
+    grabber["openCloseMotorDiagnostics"]["rpm"] = 0;
+    grabber["rotateMotorDiagnostics"]["overcurrent"] = false;
+    grabber["rotateMotorDiagnostics"]["current"] = 30;
+    grabber["rotateMotorDiagnostics"]["pwm"] = 40;
+    grabber["rotateMotorDiagnostics"]["rpm"] = 0;
+
+    Json::FastWriter writer;
+    string errors;
+    parser.parseJSONMessage(writer.write(root).c_str(), errors);
+    auto actual = parser.getGrabberMotorStates("revolution_id123");
+
+    ASSERT_TRUE(actual.open_close_motor_overcurrent);
+    ASSERT_FALSE(actual.rotate_overcurrent);
+    ASSERT_NEAR(0.2, actual.motor_states.elements[0].raw, 1e-6);
+    ASSERT_NEAR(30, actual.motor_states.elements[1].effort, 1e-6);
+}
+
+TEST_F(MessageParserTest, it_does_not_modify_the_message_when_querying_missing_fields)
+{
+    auto parser = getMessageParser();
+    Json::Value root;
+    root["payload"]["devices"]["revolution_id123"]["model"] = 13;
+
+    Json::FastWriter writer;
+    string errors;
+    parser.parseJSONMessage(writer.write(root).c_str(), errors);
+    ASSERT_ANY_THROW(parser.getCameraHeadStates("revolution_id123"));
+    ASSERT_ANY_THROW(parser.getBatteryStates("revolution_id123", "battery1"));
+    ASSERT_ANY_THROW(parser.isLeaking("reel_id123"));
+    ASSERT_TRUE(parser.getDeviceJson("reel_id123").isNull());
+
+    ASSERT_EQ(root, parser.getJson());
+}
+
+static Json::Value fullRevolutionStateMessage()
+{
+    Json::Value root;
+    root["apiVersion"] = "0.20.0";
+    root["method"] = "GET";
+    auto& rev = root["payload"]["devices"]["rev"];
+    rev["model"] = 13;
+    rev["depth"] = 12.5;
+    rev["roll"] = 2.0;
+    rev["pitch"] = -4.0;
+    rev["heading"] = 270.0;
+    rev["cpuTemp"] = 51;
+    rev["usageTime"]["currentSeconds"] = 3600;
+    rev["auxLight"]["intensity"] = 25;
+    rev["drive"]["thrust"]["forward"] = 10;
+    rev["drive"]["thrust"]["lateral"] = -20;
+    rev["drive"]["thrust"]["vertical"] = 30;
+    rev["drive"]["thrust"]["yaw"] = 0;
+    rev["drive"]["modes"]["autoStabilization"] = true;
+    rev["drive"]["modes"]["motorsDisabled"] = false;
+    rev["drive"]["modes"]["altitudeLock"] = false;
+    rev["drive"]["modes"]["depthLock"] = true;
+    rev["drive"]["modes"]["headingLock"] = false;
+    vector<string> motors{"frontRightMotorDiagnostics",
+        "frontLeftMotorDiagnostics",
+        "rearRightMotorDiagnostics",
+        "rearLeftMotorDiagnostics",
+        "verticalRightMotorDiagnostics",
+        "verticalLeftMotorDiagnostics"};
+    for (size_t i = 0; i < motors.size(); ++i) {
+        rev[motors[i]]["pwm"] = static_cast<int>(10 * i);
+        rev[motors[i]]["current"] = static_cast<int>(100 + i);
+        rev[motors[i]]["rpm"] = static_cast<int>(1000 - 10 * i);
+        rev[motors[i]]["overcurrent"] = (i == 2);
+    }
+    auto& camera_head = rev["cameraHead"];
+    camera_head["light"]["intensity"] = 40;
+    camera_head["lasers"]["enabled"] = true;
+    camera_head["leak"] = false;
+    camera_head["tilt"]["position"] = 30;
+    camera_head["tiltMotorDiagnostics"]["overcurrent"] = false;
+    camera_head["tiltMotorDiagnostics"]["rpm"] = 20;
+    camera_head["tiltMotorDiagnostics"]["pwm"] = 80;
+    camera_head["tiltMotorDiagnostics"]["current"] = 60;
+    camera_head["firmware"]["versions"].append(1);
+    camera_head["firmware"]["versions"].append("two");
+    root["payload"]["devices"]["other"]["distance"] = 150;
+    return root;
+}
+
+TEST_F(MessageParserTest, it_decodes_the_same_states_in_streaming_mode_than_in_dom_mode)
+{
+    Json::FastWriter writer;
+    string message = writer.write(fullRevolutionStateMessage());
+
+    auto dom = getMessageParser();
+    string errors;
+    ASSERT_TRUE(dom.parseJSONMessage(message.c_str(), errors));
+    auto const& expected = dom.decodeSnapshot("rev");
+
+    auto streaming = getMessageParser();
+    streaming.setDecodeMode(CommandAndStateMessageParser::DECODE_STREAMING);
+    ASSERT_TRUE(streaming.parseJSONMessage(message.c_str(), errors));
+    auto const& actual = streaming.decodeSnapshot("rev");
+
+    ASSERT_EQ(expected.field_groups, actual.field_groups);
+    ASSERT_DOUBLE_EQ(expected.revolution.pose.position.z(),
+        actual.revolution.pose.position.z());
+    ASSERT_TRUE(expected.revolution.pose.orientation.isApprox(
+        actual.revolution.pose.orientation));
+    ASSERT_TRUE(expected.revolution.drive_setpoint.position.isApprox(
+        actual.revolution.drive_setpoint.position));
+    ASSERT_EQ(expected.revolution.drive_modes.depth_lock,
+        actual.revolution.drive_modes.depth_lock);
+    ASSERT_EQ(expected.revolution.auto_stabilization,
+        actual.revolution.auto_stabilization);
+    ASSERT_EQ(expected.revolution.rear_right_motor_overcurrent,
+        actual.revolution.rear_right_motor_overcurrent);
+    ASSERT_EQ(6, actual.revolution.motor_states.elements.size());
+    for (size_t i = 0; i < 6; ++i) {
+        auto const& expected_joint = expected.revolution.motor_states.elements[i];
+        auto const& actual_joint = actual.revolution.motor_states.elements[i];
+        ASSERT_FLOAT_EQ(expected_joint.raw, actual_joint.raw);
+        ASSERT_FLOAT_EQ(expected_joint.speed, actual_joint.speed);
+        ASSERT_FLOAT_EQ(expected_joint.effort, actual_joint.effort);
+    }
+    ASSERT_DOUBLE_EQ(expected.revolution.camera_head.light,
+        actual.revolution.camera_head.light);
+    ASSERT_DOUBLE_EQ(expected.revolution.camera_head.motor_states.elements[0].position,
+        actual.revolution.camera_head.motor_states.elements[0].position);
+    ASSERT_DOUBLE_EQ(expected.revolution.aux_light, actual.revolution.aux_light);
+    ASSERT_EQ(expected.revolution.usage_time, actual.revolution.usage_time);
+    ASSERT_FLOAT_EQ(expected.revolution.cpu_temperature,
+        actual.revolution.cpu_temperature);
+
+    ASSERT_NEAR(streaming.computeCameraHead2BodyTilt("rev").getRad(),
+        dom.computeCameraHead2BodyTilt("rev").getRad(),
+        1e-9);
+    ASSERT_NEAR(1.5, streaming.getTetherLength("other"), 1e-9);
+}
+
+TEST_F(MessageParserTest, it_reports_missing_fields_in_streaming_mode)
+{
+    auto parser = getMessageParser();
+    parser.setDecodeMode(CommandAndStateMessageParser::DECODE_STREAMING);
+
+    Json::FastWriter writer;
+    string errors;
+    ASSERT_TRUE(
+        parser.parseJSONMessage(writer.write(fullRevolutionStateMessage()).c_str(),
+            errors));
+    ASSERT_ANY_THROW(parser.getBatteryStates("rev", "battery1"));
+    ASSERT_ANY_THROW(parser.getCameras("rev"));
+    ASSERT_ANY_THROW(parser.isLeaking("unknown"));
+
+    Json::Value root;
+    root["payload"]["devices"]["rev"]["leak"] = true;
+    ASSERT_TRUE(parser.parseJSONMessage(writer.write(root).c_str(), errors));
+    ASSERT_TRUE(parser.isLeaking("rev"));
+    ASSERT_ANY_THROW(parser.getRevolutionPoseZAttitude("rev"));
+}
+
+TEST_F(MessageParserTest, it_reports_invalid_json_in_streaming_mode)
+{
+    auto parser = getMessageParser();
+    parser.setDecodeMode(CommandAndStateMessageParser::DECODE_STREAMING);
+
+    string errors;
+    ASSERT_FALSE(parser.parseJSONMessage("{\"payload\": {\"devices\": [1, }", errors));
+    ASSERT_FALSE(errors.empty());
+}
+
+TEST_F(MessageParserTest, it_parses_a_message_that_is_not_nul_terminated)
+{
+    for (auto mode : {CommandAndStateMessageParser::DECODE_DOM,
+             CommandAndStateMessageParser::DECODE_STREAMING}) {
+        auto parser = getMessageParser();
+        parser.setDecodeMode(mode);
+
+        string buffer = "{\"payload\":{\"devices\":{\"rev\":{\"leak\":true}}}}garbage";
+        string_view message(buffer.data(), buffer.size() - 7);
+        string errors;
+        ASSERT_TRUE(parser.parseJSONMessage(message, errors)) << errors;
+        ASSERT_TRUE(parser.isLeaking("rev"));
+    }
+}
+
+TEST_F(MessageParserTest, it_parses_each_record_of_a_multi_record_buffer_in_place)
+{
+    for (auto mode : {CommandAndStateMessageParser::DECODE_DOM,
+             CommandAndStateMessageParser::DECODE_STREAMING}) {
+        auto parser = getMessageParser();
+        parser.setDecodeMode(mode);
+
+        string buffer = "{\"payload\":{\"devices\":{\"rev\":{\"cpuTemp\":10}}}}\n"
+                        "\n"
+                        "{\"payload\":{\"devices\":{\"rev\":{\"cpuTemp\":20}}}}\n"
+                        "{\"payload\": invalid}\n"
+                        "{\"payload\":{\"devices\":{\"rev\":{\"cpuTemp\":30}}}}";
+        vector<double> temperatures;
+        vector<char const*> records;
+        string errors;
+        bool result = parser.parseJSONRecords(
+            buffer,
+            '\n',
+            [&](string_view record) {
+                records.push_back(record.data());
+                temperatures.push_back(parser.getCpuTemperature("rev"));
+            },
+            errors);
+
+        ASSERT_FALSE(result);
+        ASSERT_EQ(0, errors.find("record 2: "));
+        ASSERT_EQ(vector<double>({10, 20, 30}), temperatures);
+        ASSERT_EQ(buffer.data(), records[0]);
+    }
+}
+
+TEST_F(MessageParserTest, it_merges_partial_messages_and_reports_the_changed_groups)
+{
+    for (auto mode : {CommandAndStateMessageParser::DECODE_DOM,
+             CommandAndStateMessageParser::DECODE_STREAMING}) {
+        auto parser = getMessageParser();
+        parser.setDecodeMode(mode);
+        parser.setStateMerging(true);
+
+        string errors;
+        parser.parseJSONMessage("{\"payload\":{\"devices\":{\"rev\":{"
+                                "\"depth\":10,\"roll\":0,\"pitch\":0,\"heading\":90}}}}",
+            errors);
+        ASSERT_EQ(FIELD_GROUP_POSE, parser.getChangedFieldGroups("rev"));
+
+        parser.parseJSONMessage(
+            "{\"payload\":{\"devices\":{\"rev\":{\"cpuTemp\":42,\"leak\":false}}}}",
+            errors);
+        ASSERT_EQ(FIELD_GROUP_CPU_TEMPERATURE | FIELD_GROUP_LEAK,
+            parser.getChangedFieldGroups("rev"));
+
+        parser.parseJSONMessage(
+            "{\"payload\":{\"devices\":{\"rev\":{\"depth\":10,\"cpuTemp\":43}}}}",
+            errors);
+        ASSERT_EQ(FIELD_GROUP_CPU_TEMPERATURE, parser.getChangedFieldGroups("rev"));
+
+        auto const& state = parser.getMergedState("rev");
+        ASSERT_TRUE(state.has(FIELD_GROUP_POSE));
+        ASSERT_TRUE(state.has(FIELD_GROUP_LEAK));
+        ASSERT_NEAR(-10, state.revolution.pose.position.z(), 1e-6);
+        ASSERT_NEAR(43, state.revolution.cpu_temperature, 1e-6);
+        ASSERT_FALSE(state.powered_reel.leak);
+
+        parser.parseJSONMessage("{\"payload\":{\"devices\":{}}}", errors);
+        ASSERT_EQ(0, parser.getChangedFieldGroups("rev"));
+        ASSERT_THROW(parser.getMergedState("other"), invalid_argument);
+    }
+}
+
+TEST_F(MessageParserTest, it_indexes_all_the_devices_of_a_message)
+{
+    for (auto mode : {CommandAndStateMessageParser::DECODE_DOM,
+             CommandAndStateMessageParser::DECODE_STREAMING}) {
+        auto parser = getMessageParser();
+        parser.setDecodeMode(mode);
+
+        string errors;
+        parser.parseJSONMessage("{\"payload\":{\"devices\":{"
+                                "\"rev\":{\"model\":13,\"cpuTemp\":40},"
+                                "\"reel\":{\"model\":12,\"cpuTemp\":30}}}}",
+            errors);
+        auto rev = parser.findDevice("rev");
+        auto reel = parser.findDevice("reel");
+        ASSERT_TRUE(rev.isValid());
+        ASSERT_TRUE(reel.isValid());
+        ASSERT_FALSE(parser.findDevice("other").isValid());
+        ASSERT_EQ(2, parser.getDevicesInMessage().size());
+        ASSERT_EQ("reel", parser.getDeviceAddress(reel));
+        ASSERT_EQ(DEVICE_MODEL_REVOLUTION, parser.getDeviceModel(rev));
+        ASSERT_EQ(DEVICE_MODEL_POWERED_REEL, parser.getDeviceModel(reel));
+        ASSERT_NEAR(30, parser.decodeSnapshot(reel).powered_reel.cpu_temperature, 1e-6);
+
+        // Handles remain valid across messages
+        parser.parseJSONMessage(
+            "{\"payload\":{\"devices\":{\"rev\":{\"cpuTemp\":41}}}}",
+            errors);
+        ASSERT_EQ(rev.index, parser.findDevice("rev").index);
+        ASSERT_TRUE(parser.isDeviceInMessage(rev));
+        ASSERT_FALSE(parser.isDeviceInMessage(reel));
+        ASSERT_EQ(0, parser.decodeSnapshot(reel).field_groups);
+        ASSERT_NEAR(41, parser.decodeSnapshot(rev).revolution.cpu_temperature, 1e-6);
+        ASSERT_THROW(parser.getCpuTemperature("reel"), invalid_argument);
+    }
+}
+
+TEST_F(MessageParserTest, it_stamps_all_the_samples_of_a_message_with_its_receive_time)
+{
+    for (auto mode : {CommandAndStateMessageParser::DECODE_DOM,
+             CommandAndStateMessageParser::DECODE_STREAMING}) {
+        auto parser = getMessageParser();
+        parser.setDecodeMode(mode);
+
+        Json::FastWriter writer;
+        string message = writer.write(fullRevolutionStateMessage());
+        auto receive_time = base::Time::now() - base::Time::fromSeconds(1);
+        string errors;
+        ASSERT_TRUE(parser.parseJSONMessage(message, receive_time, errors));
+
+        ASSERT_EQ(receive_time, parser.getReceiveTime());
+        ASSERT_GE(parser.getDecodeLatency(), base::Time::fromSeconds(1));
+        ASSERT_EQ(receive_time, parser.getRevolutionPoseZAttitude("rev").time);
+        ASSERT_EQ(receive_time, parser.getRevolutionMotorStates("rev").time);
+        ASSERT_EQ(receive_time, parser.getCameraHeadStates("rev").time);
+        ASSERT_EQ(receive_time, parser.getRevolutionDriveModes("rev").time);
+        ASSERT_EQ(receive_time, parser.getRevolutionDriveStates("rev").time);
+    }
+}
+
+TEST_F(MessageParserTest, it_reports_camera_changes_between_messages)
+{
+    auto parser = getMessageParser();
+    Json::Value root;
+    auto& camera = root["payload"]["devices"]["rev"]["cameras"]["cam"];
+    camera["model"] = 5;
+    camera["ip"] = "1.1.1.1";
+    camera["type"] = "some-type";
+    camera["osd"]["enabled"] = true;
+    camera["streams"]["main"]["active"] = true;
+    camera["streams"]["secondary"]["active"] = false;
+
+    Json::FastWriter writer;
+    string errors;
+    parser.parseJSONMessage(writer.write(root), errors);
+    ASSERT_TRUE(parser.haveCamerasChanged("rev"));
+    auto changes = parser.getCameraStreamChanges("rev");
+    ASSERT_EQ(1, changes.size());
+    ASSERT_EQ("cam", changes[0].camera_id);
+    ASSERT_EQ("main", changes[0].stream_id);
+    ASSERT_TRUE(changes[0].active);
+
+    auto time = base::Time::now();
+    parser.parseJSONMessage(writer.write(root), time, errors);
+    ASSERT_FALSE(parser.haveCamerasChanged("rev"));
+    ASSERT_TRUE(parser.getCameraStreamChanges("rev").empty());
+    auto cameras = parser.getCameras("rev");
+    ASSERT_EQ(1, cameras.size());
+    ASSERT_EQ(time, cameras[0].time);
+    ASSERT_EQ(vector<string>{"main"}, cameras[0].active_streams);
+
+    camera["streams"]["main"]["active"] = false;
+    camera["streams"]["secondary"]["active"] = true;
+    parser.parseJSONMessage(writer.write(root), errors);
+    ASSERT_TRUE(parser.haveCamerasChanged("rev"));
+    changes = parser.getCameraStreamChanges("rev");
+    ASSERT_EQ(2, changes.size());
+    ASSERT_EQ("secondary", changes[0].stream_id);
+    ASSERT_TRUE(changes[0].active);
+    ASSERT_EQ("main", changes[1].stream_id);
+    ASSERT_FALSE(changes[1].active);
+    ASSERT_EQ(vector<string>{"secondary"}, parser.getCameras("rev")[0].active_streams);
+}
+
+TEST_F(MessageParserTest, it_reports_the_missing_fields_of_field_groups)
+{
+    Json::Value root;
+    root["payload"]["devices"]["rev"]["depth"] = 10;
+    root["payload"]["devices"]["rev"]["roll"] = 0;
+    root["payload"]["devices"]["rev"]["drive"]["thrust"]["forward"] = 0;
+    Json::FastWriter writer;
+
+    for (auto mode : {CommandAndStateMessageParser::DECODE_DOM,
+             CommandAndStateMessageParser::DECODE_STREAMING}) {
+        CommandAndStateMessageParser parser;
+        parser.setDecodeMode(mode);
+        string errors;
+        parser.parseJSONMessage(writer.write(root), errors);
+
+        auto missing =
+            parser.getMissingFields("rev", FIELD_GROUP_POSE | FIELD_GROUP_DRIVE_THRUST);
+        ASSERT_EQ(5, missing.count());
+        ASSERT_EQ("pitch, heading, drive.thrust.lateral, drive.thrust.vertical, "
+                  "drive.thrust.yaw",
+            StreamingStateDecoder::describeFields(missing));
+        ASSERT_TRUE(parser.getMissingFields("rev", FIELD_GROUP_MODEL).any());
+        ASSERT_THROW(parser.getMissingFields("other", FIELD_GROUP_POSE),
+            invalid_argument);
+    }
+}
+
+TEST_F(MessageParserTest, it_generates_get_requests_from_the_field_descriptors)
+{
+    static_assert(fieldCount(FIELD_GROUP_POSE) == 4, "");
+    static_assert(fieldCount(FIELD_GROUP_REVOLUTION_MOTORS) == 18, "");
+
+    CommandAndStateMessageParser parser;
+    auto request = parser.getRequest("0.20.0",
+        "abcd",
+        FIELD_GROUP_DRIVE_MODES | FIELD_GROUP_AUX_LIGHT);
+
+    Json::Value expected_json;
+    expected_json["apiVersion"] = "0.20.0";
+    expected_json["method"] = "GET";
+    auto& device = expected_json["payload"]["devices"]["abcd"];
+    device["auxLight"]["intensity"] = 0;
+    device["drive"]["modes"]["autoStabilization"] = false;
+    device["drive"]["modes"]["motorsDisabled"] = false;
+    device["drive"]["modes"]["altitudeLock"] = false;
+    device["drive"]["modes"]["depthLock"] = false;
+    device["drive"]["modes"]["headingLock"] = false;
+    Json::FastWriter writer;
+    ASSERT_EQ(writer.write(expected_json), request);
+}
+
+TEST_F(MessageParserTest, it_reports_missing_states_without_throwing)
+{
+    for (auto mode : {CommandAndStateMessageParser::DECODE_DOM,
+             CommandAndStateMessageParser::DECODE_STREAMING}) {
+        auto parser = getMessageParser();
+        parser.setDecodeMode(mode);
+
+        string errors;
+        ASSERT_TRUE(parser.parseJSONMessage(
+            "{\"payload\":{\"devices\":{\"reel\":{\"leak\":true,\"cpuTemp\":40}}}}",
+            errors));
+        ASSERT_EQ(FIELD_GROUP_LEAK | FIELD_GROUP_CPU_TEMPERATURE,
+            parser.getPresentFieldGroups("reel"));
+        ASSERT_EQ(0, parser.getPresentFieldGroups("other"));
+
+        bool leak = false;
+        ASSERT_TRUE(parser.tryIsLeaking("reel", leak));
+        ASSERT_TRUE(leak);
+        double temperature = 0;
+        ASSERT_TRUE(parser.tryGetCpuTemperature("reel", temperature));
+        ASSERT_EQ(40, temperature);
+
+        double tether_length = -1;
+        ASSERT_FALSE(parser.tryGetTetherLength("reel", tether_length));
+        ASSERT_EQ(-1, tether_length);
+        power_base::BatteryStatus battery;
+        ASSERT_FALSE(parser.tryGetBatteryStates("reel", "battery1", battery));
+        bool overcurrent = false;
+        string motor = "motor1Diagnostics";
+        ASSERT_FALSE(parser.tryGetMotorOvercurrentStates("reel", motor, overcurrent));
+        ASSERT_FALSE(parser.tryIsEStopEnabled("other", leak));
+    }
+}
+
+TEST_F(MessageParserTest, it_fills_caller_owned_samples_in_place)
+{
+    for (auto mode : {CommandAndStateMessageParser::DECODE_DOM,
+             CommandAndStateMessageParser::DECODE_STREAMING}) {
+        auto parser = getMessageParser();
+        parser.setDecodeMode(mode);
+
+        Json::FastWriter writer;
+        string message = writer.write(fullRevolutionStateMessage());
+        string errors;
+        ASSERT_TRUE(parser.parseJSONMessage(message, errors));
+
+        base::samples::Joints motors;
+        parser.getRevolutionMotorStates("rev", motors);
+        auto const* elements = motors.elements.data();
+        TiltCameraHead camera_head;
+        parser.getCameraHeadStates("rev", camera_head);
+        auto const* tilt = camera_head.motor_states.elements.data();
+
+        ASSERT_TRUE(parser.parseJSONMessage(message, errors));
+        parser.getRevolutionMotorStates("rev", motors);
+        parser.getCameraHeadStates("rev", camera_head);
+        ASSERT_EQ(elements, motors.elements.data());
+        ASSERT_EQ(tilt, camera_head.motor_states.elements.data());
+
+        auto expected = parser.getRevolutionMotorStates("rev");
+        ASSERT_EQ(expected.elements.size(), motors.elements.size());
+        for (size_t i = 0; i < expected.elements.size(); ++i) {
+            ASSERT_EQ(expected.elements[i].speed, motors.elements[i].speed);
+            ASSERT_EQ(expected.elements[i].raw, motors.elements[i].raw);
+        }
+
+        base::samples::Joints reel;
+        ASSERT_THROW(parser.getPoweredReelMotorState("rev", reel), invalid_argument);
+    }
+}
+
+TEST_F(MessageParserTest, it_encodes_and_decodes_the_zoom_camera_settings)
+{
+    TamronHarrierZoomCameraCommand command;
+    command.exposure = 0.5;
+    command.brightness = 1.2;
+    command.focus = 0.25;
+    command.saturation = -0.1;
+    command.sharpness = 0.75;
+    command.zoom.ratio = 12.34;
+    command.zoom.speed = -0.5;
+
+    auto parser = getMessageParser();
+    string message = parser.parseZoomCameraCommandMessage("12.0.2",
+        "1.2.3.4.5.6",
+        13,
+        "zoom0",
+        command);
+    string errors;
+    ASSERT_TRUE(parser.parseJSONMessage(message, errors));
+
+    auto states = parser.getZoomCameraStates("1.2.3.4.5.6", "zoom0");
+    ASSERT_FLOAT_EQ(0.5, states.exposure);
+    ASSERT_FLOAT_EQ(1, states.brightness);
+    ASSERT_FLOAT_EQ(0.25, states.focus);
+    ASSERT_FLOAT_EQ(0, states.saturation);
+    ASSERT_FLOAT_EQ(0.75, states.sharpness);
+    ASSERT_FLOAT_EQ(12.3, states.zoom.ratio);
+    ASSERT_FLOAT_EQ(-0.5, states.zoom.speed);
+
+    TamronHarrierZoomCamera missing;
+    ASSERT_FALSE(parser.tryGetZoomCameraStates("1.2.3.4.5.6", "zoom1", missing));
+    ASSERT_THROW(parser.getZoomCameraStates("1.2.3.4.5.6", "zoom1"), invalid_argument);
+}
+
+TEST_F(MessageParserTest, it_rejects_zoom_camera_settings_of_invalid_type)
+{
+    auto parser = getMessageParser();
+    Json::Value msg;
+    Json::Value& cameras = msg["payload"]["devices"]["1.2.3.4.5.6"]["cameras"];
+    msg["payload"]["devices"]["1.2.3.4.5.6"]["model"] = 13;
+    for (auto camera_id : {"zoom0", "zoom1", "zoom2"}) {
+        for (auto field :
+            {"exposure", "brightness", "focus", "saturation", "sharpness"}) {
+            cameras[camera_id][field] = 50;
+        }
+        cameras[camera_id]["zoom"]["ratio"] = 2;
+        cameras[camera_id]["zoom"]["speed"] = 0;
+    }
+    cameras["zoom0"]["exposure"] = "x";
+    cameras["zoom1"]["focus"] = Json::Value();
+    cameras["zoom2"]["zoom"]["speed"] = Json::Value(Json::objectValue);
+    Json::FastWriter writer;
+    string errors;
+    ASSERT_TRUE(parser.parseJSONMessage(writer.write(msg), errors));
+
+    for (auto camera_id : {"zoom0", "zoom1", "zoom2"}) {
+        TamronHarrierZoomCamera states;
+        ASSERT_FALSE(parser.tryGetZoomCameraStates("1.2.3.4.5.6", camera_id, states));
+        ASSERT_THROW(parser.getZoomCameraStates("1.2.3.4.5.6", camera_id),
+            invalid_argument);
+    }
+}
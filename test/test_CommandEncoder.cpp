@@ -0,0 +1,99 @@
+#include <deep_trekker/CommandAndStateMessageParser.hpp>
+#include <deep_trekker/CommandEncoder.hpp>
+#include <gtest/gtest.h>
+
+using namespace std;
+using namespace base;
+using namespace deep_trekker;
+
+struct CommandEncoderTest : public ::testing::Test {
+    string api_version = "12.0.2";
+    string address = "1.2.3.4.5.6";
+    int model = 13;
+    int camera_head_model = 102;
+
+    CommandAndStateMessageParser parser;
+    CommandEncoder encoder{api_version, address, model, camera_head_model};
+
+    static samples::Joints speed(float value)
+    {
+        return samples::Joints::Speeds(vector<float>{value});
+    }
+};
+
+TEST_F(CommandEncoderTest, it_encodes_the_drive_modes_like_the_parser)
+{
+    for (int i = 0; i < 8; ++i) {
+        DriveMode modes;
+        modes.altitude_lock = i & 1;
+        modes.depth_lock = i & 2;
+        modes.heading_lock = i & 4;
+        ASSERT_EQ(parser.parseDriveModeRevolutionCommandMessage(api_version,
+                      address,
+                      model,
+                      modes),
+            encoder.encodeDriveModes(modes));
+    }
+}
+
+TEST_F(CommandEncoderTest, it_encodes_the_boolean_commands_like_the_parser)
+{
+    for (bool value : {false, true}) {
+        ASSERT_EQ(parser.parseAutoStabilizationRevolutionCommandMessage(api_version,
+                      address,
+                      model,
+                      value),
+            encoder.encodeAutoStabilization(value));
+        ASSERT_EQ(parser.parseMotorsDisabledRevolutionCommandMessage(api_version,
+                      address,
+                      model,
+                      value),
+            encoder.encodeMotorsDisabled(value));
+        ASSERT_EQ(parser.parseCameraHeadLaserMessage(api_version,
+                      address,
+                      model,
+                      camera_head_model,
+                      value),
+            encoder.encodeCameraHeadLaser(value));
+    }
+}
+
+TEST_F(CommandEncoderTest, it_encodes_the_setpoints_like_the_parser)
+{
+    for (double value : {-2.0, -1.0, -0.505, -0.21, 0.0, 0.001, 0.3333, 0.5, 1.0, 3.0}) {
+        commands::LinearAngular6DCommand drive;
+        drive.linear = Eigen::Vector3d(value, -value / 2, value / 3);
+        drive.angular = Eigen::Vector3d(0, 0, -value);
+        ASSERT_EQ(
+            parser.parseDriveRevolutionCommandMessage(api_version, address, model, drive),
+            encoder.encodeDrive(drive));
+
+        ASSERT_EQ(parser.parsePoweredReelCommandMessage(api_version,
+                      address,
+                      model,
+                      speed(value)),
+            encoder.encodePoweredReel(speed(value)));
+        ASSERT_EQ(parser.parseTiltCameraHeadCommandMessage(api_version,
+                      address,
+                      model,
+                      camera_head_model,
+                      speed(value)),
+            encoder.encodeCameraHeadTilt(speed(value)));
+        ASSERT_EQ(parser.parseCameraHeadLightMessage(api_version,
+                      address,
+                      model,
+                      camera_head_model,
+                      value),
+            encoder.encodeCameraHeadLight(value));
+        ASSERT_EQ(
+            parser.parseAuxLightCommandMessage(api_version, address, model, value),
+            encoder.encodeAuxLight(value));
+
+        samples::Joints grabber;
+        grabber.elements.resize(2);
+        grabber.elements[0].raw = value;
+        grabber.elements[1].raw = -value / 3;
+        ASSERT_EQ(parser.parseGrabberCommandMessage(api_version, address, grabber),
+            encoder.encodeGrabber(grabber));
+    }
+}
@@ -0,0 +1,55 @@
+#include <deep_trekker/CommandSender.hpp>
+#include <gtest/gtest.h>
+
+using namespace std;
+using namespace base;
+using namespace deep_trekker;
+
+struct CommandSenderTest : public ::testing::Test {
+    vector<string> sent;
+    CommandEncoder encoder{"12.0.2", "rev", 13, 102};
+    CommandSender sender{encoder,
+        [this](string const& msg) { sent.push_back(msg); },
+        Time::fromSeconds(1),
+        Time::fromMilliseconds(100)};
+    Time start = Time::now();
+};
+
+TEST_F(CommandSenderTest, it_suppresses_unchanged_commands)
+{
+    ASSERT_TRUE(sender.sendCameraHeadLight(0.5, start));
+    ASSERT_FALSE(sender.sendCameraHeadLight(0.5, start + Time::fromMilliseconds(100)));
+    ASSERT_FALSE(sender.sendCameraHeadLight(0.501, start + Time::fromMilliseconds(200)));
+    ASSERT_TRUE(sender.sendCameraHeadLight(0.6, start + Time::fromMilliseconds(300)));
+    ASSERT_TRUE(sender.sendAuxLight(0.6, start + Time::fromMilliseconds(300)));
+
+    ASSERT_EQ(3, sent.size());
+    ASSERT_EQ(encoder.encodeCameraHeadLight(0.6), sent[1]);
+    ASSERT_EQ(3, sender.getSentCount());
+    ASSERT_EQ(2, sender.getSuppressedCount());
+}
+
+TEST_F(CommandSenderTest, it_resends_unchanged_commands_at_the_keepalive_period)
+{
+    DriveMode modes{};
+    ASSERT_TRUE(sender.sendDriveModes(modes, start));
+    ASSERT_FALSE(sender.sendDriveModes(modes, start + Time::fromMilliseconds(999)));
+    ASSERT_TRUE(sender.sendDriveModes(modes, start + Time::fromSeconds(1)));
+}
+
+TEST_F(CommandSenderTest, it_uses_a_separate_keepalive_period_for_the_drive)
+{
+    commands::LinearAngular6DCommand drive;
+    drive.linear = Eigen::Vector3d(0.1, 0, 0);
+    drive.angular = Eigen::Vector3d::Zero();
+    ASSERT_TRUE(sender.sendDrive(drive, start));
+    ASSERT_FALSE(sender.sendDrive(drive, start + Time::fromMilliseconds(50)));
+    ASSERT_TRUE(sender.sendDrive(drive, start + Time::fromMilliseconds(100)));
+}
+
+TEST_F(CommandSenderTest, it_sends_all_commands_again_after_a_reset)
+{
+    ASSERT_TRUE(sender.sendCameraHeadLaser(true, start));
+    sender.reset();
+    ASSERT_TRUE(sender.sendCameraHeadLaser(true, start));
+}
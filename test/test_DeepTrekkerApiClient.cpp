@@ -0,0 +1,141 @@
+#include <deep_trekker/DeepTrekkerApiClient.hpp>
+#include <gtest/gtest.h>
+
+using namespace std;
+using namespace base;
+using namespace deep_trekker;
+
+struct DeepTrekkerApiClientTest : public ::testing::Test {
+    vector<string> sent;
+    DeepTrekkerApiClient client{[this](string const& msg) { sent.push_back(msg); },
+        Time::fromMilliseconds(500),
+        2};
+    CommandAndStateMessageParser parser;
+    Time start = Time::now();
+
+    string poseRequest(string const& address)
+    {
+        return parser.getRequestForRevolutionPoseZAttitude("12.0.2", address);
+    }
+
+    string poseReply(string const& address, double depth)
+    {
+        return "{\"apiVersion\":\"12.0.2\",\"method\":\"GET\",\"payload\":{"
+               "\"devices\":{\"" +
+               address + "\":{\"model\":13,\"depth\":" + to_string(depth) +
+               ",\"roll\":0,\"pitch\":0,\"heading\":0}}}}";
+    }
+};
+
+TEST_F(DeepTrekkerApiClientTest, it_matches_pipelined_replies_to_their_requests)
+{
+    vector<DeepTrekkerApiClient::Reply> replies;
+    auto on_reply = [&](DeepTrekkerApiClient::Reply const& r) { replies.push_back(r); };
+    auto rev = client.request(poseRequest("rev"), on_reply, start);
+    auto other = client.request(poseRequest("other"), on_reply, start);
+    ASSERT_EQ(2, sent.size());
+    ASSERT_EQ(2, client.getInFlightCount());
+
+    client.handleMessage(poseReply("other", 2), start + Time::fromMilliseconds(10));
+    client.handleMessage(poseReply("rev", 1), start + Time::fromMilliseconds(20));
+
+    ASSERT_EQ(2, replies.size());
+    ASSERT_EQ(other, replies[0].id);
+    ASSERT_EQ(DeepTrekkerApiClient::REPLY_RECEIVED, replies[0].status);
+    ASSERT_FLOAT_EQ(-2, replies[0].snapshots["other"].revolution.pose.position.z());
+    ASSERT_EQ(rev, replies[1].id);
+    ASSERT_EQ(start + Time::fromMilliseconds(20), replies[1].receive_time);
+    ASSERT_EQ(0, client.getInFlightCount());
+}
+
+TEST_F(DeepTrekkerApiClientTest, it_does_not_match_broadcasts_to_pending_requests)
+{
+    for (auto mode : {CommandAndStateMessageParser::DECODE_DOM,
+             CommandAndStateMessageParser::DECODE_STREAMING}) {
+        client.setDecodeMode(mode);
+        int unsolicited = 0;
+        client.onUnsolicitedMessage(
+            [&](CommandAndStateMessageParser&) { ++unsolicited; });
+        vector<DeepTrekkerApiClient::Reply> replies;
+        auto on_reply = [&](DeepTrekkerApiClient::Reply const& r) {
+            replies.push_back(r);
+        };
+        auto first = client.request(poseRequest("rev"), on_reply, start);
+        auto second = client.request(poseRequest("rev"), on_reply, start);
+
+        client.handleMessage(poseReply("rev", 1), start);
+        // A SET reply, and a broadcast that lacks the requested fields
+        client.handleMessage("{\"method\":\"SET\",\"payload\":{\"devices\":{\"rev\":"
+                             "{\"model\":13,\"depth\":5,\"roll\":0,\"pitch\":0,"
+                             "\"heading\":0}}}}",
+            start);
+        client.handleMessage("{\"method\":\"GET\",\"payload\":{\"devices\":{\"rev\":"
+                             "{\"model\":13,\"cpuTemp\":40}}}}",
+            start);
+        client.handleMessage(poseReply("rev", 2), start);
+
+        ASSERT_EQ(2, unsolicited);
+        ASSERT_EQ(2, replies.size());
+        ASSERT_EQ(first, replies[0].id);
+        ASSERT_FLOAT_EQ(-1, replies[0].snapshots["rev"].revolution.pose.position.z());
+        ASSERT_EQ(second, replies[1].id);
+        ASSERT_FLOAT_EQ(-2, replies[1].snapshots["rev"].revolution.pose.position.z());
+    }
+}
+
+TEST_F(DeepTrekkerApiClientTest, it_queues_requests_beyond_the_in_flight_limit)
+{
+    auto first = client.request(poseRequest("rev"), start);
+    client.request(poseRequest("rev"), start);
+    auto third = client.request(poseRequest("rev"), start);
+    ASSERT_EQ(2, sent.size());
+    ASSERT_EQ(1, client.getQueuedCount());
+
+    client.handleMessage(poseReply("rev", 1), start + Time::fromMilliseconds(10));
+    ASSERT_EQ(3, sent.size());
+    ASSERT_EQ(0, client.getQueuedCount());
+    ASSERT_EQ(DeepTrekkerApiClient::REPLY_RECEIVED, first.get().status);
+    ASSERT_EQ(future_status::timeout, third.wait_for(chrono::seconds(0)));
+}
+
+TEST_F(DeepTrekkerApiClientTest, it_times_out_requests_that_get_no_reply)
+{
+    auto reply = client.request(poseRequest("rev"), start);
+    client.expireRequests(start + Time::fromMilliseconds(499));
+    ASSERT_EQ(future_status::timeout, reply.wait_for(chrono::seconds(0)));
+    client.expireRequests(start + Time::fromMilliseconds(500));
+    ASSERT_EQ(DeepTrekkerApiClient::REPLY_TIMED_OUT, reply.get().status);
+}
+
+TEST_F(DeepTrekkerApiClientTest, it_passes_messages_that_match_no_request_along)
+{
+    int unsolicited = 0;
+    client.onUnsolicitedMessage([&](CommandAndStateMessageParser& parser) {
+        ++unsolicited;
+        ASSERT_TRUE(parser.isDeviceInMessage(parser.findDevice("rev")));
+    });
+    client.handleMessage(poseReply("rev", 1), start);
+    ASSERT_EQ(1, unsolicited);
+}
+
+TEST_F(DeepTrekkerApiClientTest, it_lets_the_unsolicited_callback_use_the_client)
+{
+    future<DeepTrekkerApiClient::Reply> follow_up;
+    size_t in_flight = 0;
+    client.onUnsolicitedMessage([&](CommandAndStateMessageParser&) {
+        follow_up = client.request(poseRequest("rev"), start);
+        in_flight = client.getInFlightCount();
+    });
+    client.handleMessage(poseReply("rev", 1), start);
+    ASSERT_EQ(1, in_flight);
+    ASSERT_EQ(1, sent.size());
+
+    client.handleMessage(poseReply("rev", 2), start + Time::fromMilliseconds(10));
+    ASSERT_EQ(DeepTrekkerApiClient::REPLY_RECEIVED, follow_up.get().status);
+}
+
+TEST_F(DeepTrekkerApiClientTest, it_rejects_requests_without_devices)
+{
+    ASSERT_THROW(client.request("{\"method\":\"GET\"}", start), invalid_argument);
+    ASSERT_THROW(client.request("{", start), invalid_argument);
+}
@@ -0,0 +1,101 @@
+#include <deep_trekker/InvocationTracker.hpp>
+#include <gtest/gtest.h>
+
+using namespace std;
+using namespace deep_trekker;
+
+struct InvocationTrackerTest : public ::testing::Test {
+    InvocationTracker tracker;
+    vector<pair<Json::Value, string>> completions;
+
+    InvocationTracker::OnCompletion recorder()
+    {
+        return [this](Json::Value const& result, string const& error) {
+            completions.emplace_back(result, error);
+        };
+    }
+
+    static Json::Value completion(string const& id)
+    {
+        Json::Value msg;
+        msg["type"] = 3;
+        msg["invocationId"] = id;
+        return msg;
+    }
+};
+
+TEST_F(InvocationTrackerTest, it_allows_several_invocations_in_flight)
+{
+    auto first = tracker.add(recorder());
+    auto second = tracker.add(recorder());
+    auto third = tracker.add(recorder());
+    ASSERT_NE(first, second);
+    ASSERT_NE(second, third);
+    ASSERT_EQ(3, tracker.getPendingCount());
+}
+
+TEST_F(InvocationTrackerTest, it_resolves_the_invocations_by_id_in_any_order)
+{
+    auto first = tracker.add(recorder());
+    auto second = tracker.add(recorder());
+
+    auto reply = completion(second);
+    reply["result"] = 42;
+    ASSERT_TRUE(tracker.complete(reply));
+    reply = completion(first);
+    reply["result"] = 10;
+    ASSERT_TRUE(tracker.complete(reply));
+
+    ASSERT_EQ(2, completions.size());
+    ASSERT_EQ(42, completions[0].first.asInt());
+    ASSERT_EQ("", completions[0].second);
+    ASSERT_EQ(10, completions[1].first.asInt());
+    ASSERT_EQ(0, tracker.getPendingCount());
+}
+
+TEST_F(InvocationTrackerTest, it_delivers_errors_to_the_failed_invocation_only)
+{
+    auto first = tracker.add(recorder());
+    tracker.add(recorder());
+
+    auto reply = completion(first);
+    reply["error"] = "no such session";
+    ASSERT_TRUE(tracker.complete(reply));
+
+    ASSERT_EQ(1, completions.size());
+    ASSERT_TRUE(completions[0].first.isNull());
+    ASSERT_EQ("no such session", completions[0].second);
+    ASSERT_EQ(1, tracker.getPendingCount());
+}
+
+TEST_F(InvocationTrackerTest, it_ignores_completions_of_unknown_invocations)
+{
+    auto id = tracker.add(recorder());
+    ASSERT_FALSE(tracker.complete(completion("1000")));
+    ASSERT_TRUE(tracker.complete(completion(id)));
+    ASSERT_FALSE(tracker.complete(completion(id)));
+    ASSERT_EQ(1, completions.size());
+}
+
+TEST_F(InvocationTrackerTest, it_fails_all_pending_invocations)
+{
+    tracker.add(recorder());
+    tracker.add(recorder());
+    tracker.failAll("connection lost");
+
+    ASSERT_EQ(2, completions.size());
+    ASSERT_EQ("connection lost", completions[0].second);
+    ASSERT_EQ("connection lost", completions[1].second);
+    ASSERT_EQ(0, tracker.getPendingCount());
+}
+
+TEST_F(InvocationTrackerTest, it_lets_callbacks_start_new_invocations)
+{
+    string next;
+    auto id = tracker.add([&](Json::Value const&, string const&) {
+        next = tracker.add(recorder());
+    });
+    ASSERT_TRUE(tracker.complete(completion(id)));
+    ASSERT_TRUE(tracker.complete(completion(next)));
+    ASSERT_EQ(1, completions.size());
+}
@@ -0,0 +1,105 @@
+#include <deep_trekker/CommandAndStateMessageParser.hpp>
+#include <deep_trekker/PollPlanner.hpp>
+#include <gtest/gtest.h>
+
+using namespace std;
+using namespace base;
+using namespace deep_trekker;
+
+struct PollPlannerTest : public ::testing::Test {
+    PollPlanner planner{"12.0.2"};
+    Time start = Time::now();
+
+    Json::Value parse(string const& request)
+    {
+        Json::Value result;
+        Json::CharReaderBuilder builder;
+        unique_ptr<Json::CharReader> reader(builder.newCharReader());
+        string errors;
+        char const* begin = request.data();
+        EXPECT_TRUE(reader->parse(begin, begin + request.size(), &result, &errors));
+        return result;
+    }
+};
+
+TEST_F(PollPlannerTest, it_polls_each_group_at_its_own_rate)
+{
+    planner.setPollPeriod("rev", FIELD_GROUP_POSE, Time::fromMilliseconds(50));
+    planner.setPollPeriod("rev",
+        FIELD_GROUP_REVOLUTION_MOTORS,
+        Time::fromMilliseconds(100));
+
+    ASSERT_FALSE(planner.tick(start).empty());
+    ASSERT_EQ(FIELD_GROUP_POSE | FIELD_GROUP_REVOLUTION_MOTORS,
+        planner.getLastRequestedGroups("rev"));
+    ASSERT_TRUE(planner.tick(start + Time::fromMilliseconds(20)).empty());
+    ASSERT_FALSE(planner.tick(start + Time::fromMilliseconds(50)).empty());
+    ASSERT_EQ(FIELD_GROUP_POSE, planner.getLastRequestedGroups("rev"));
+    ASSERT_FALSE(planner.tick(start + Time::fromMilliseconds(100)).empty());
+    ASSERT_EQ(FIELD_GROUP_POSE | FIELD_GROUP_REVOLUTION_MOTORS,
+        planner.getLastRequestedGroups("rev"));
+}
+
+TEST_F(PollPlannerTest, it_merges_the_due_groups_of_all_devices_in_one_request)
+{
+    planner.setPollPeriod("rev", FIELD_GROUP_POSE, Time::fromMilliseconds(50));
+    planner.setPollPeriod("reel",
+        FIELD_GROUP_BATTERY_1 | FIELD_GROUP_CPU_TEMPERATURE,
+        Time::fromSeconds(2));
+
+    auto request = parse(planner.tick(start));
+    ASSERT_EQ("GET", request["method"].asString());
+    ASSERT_EQ("12.0.2", request["apiVersion"].asString());
+    auto const& devices = request["payload"]["devices"];
+    ASSERT_EQ(0, devices["rev"]["depth"].asDouble());
+    ASSERT_EQ(0, devices["rev"]["heading"].asDouble());
+    ASSERT_FALSE(devices["rev"].isMember("cpuTemp"));
+    ASSERT_TRUE(devices["reel"].isMember("cpuTemp"));
+    ASSERT_TRUE(devices["reel"]["battery1"].isMember("voltage"));
+    ASSERT_FALSE(devices["reel"].isMember("depth"));
+}
+
+TEST_F(PollPlannerTest, it_generates_the_same_fields_than_the_legacy_request_builders)
+{
+    planner.setPollPeriod("1.2.3.4.5.6",
+        FIELD_GROUP_DISTANCE | FIELD_GROUP_LEAK | FIELD_GROUP_CPU_TEMPERATURE |
+            FIELD_GROUP_BATTERY_1 | FIELD_GROUP_BATTERY_2 | FIELD_GROUP_AC_CONNECTED |
+            FIELD_GROUP_ESTOP | FIELD_GROUP_POWERED_REEL_MOTORS |
+            FIELD_GROUP_POWERED_REEL_MOTORS_OVERCURRENT,
+        Time::fromSeconds(1));
+
+    CommandAndStateMessageParser parser;
+    auto expected =
+        parse(parser.getRequestForPoweredReelStates("12.0.2", "1.2.3.4.5.6"));
+    ASSERT_EQ(expected, parse(planner.tick(start)));
+}
+
+TEST_F(PollPlannerTest, it_requests_on_demand_groups_once)
+{
+    planner.requestOnce("rev", FIELD_GROUP_CAMERAS);
+    auto request = parse(planner.tick(start));
+    ASSERT_TRUE(request["payload"]["devices"]["rev"]["cameras"].isObject());
+    ASSERT_TRUE(planner.tick(start + Time::fromSeconds(1)).empty());
+}
+
+TEST_F(PollPlannerTest, it_stops_polling_groups_whose_period_is_null)
+{
+    planner.setPollPeriod("rev",
+        FIELD_GROUP_POSE | FIELD_GROUP_LEAK,
+        Time::fromMilliseconds(50));
+    planner.setPollPeriod("rev", FIELD_GROUP_POSE, Time());
+    planner.tick(start);
+    ASSERT_EQ(FIELD_GROUP_LEAK, planner.getLastRequestedGroups("rev"));
+}
+
+TEST_F(PollPlannerTest, it_returns_the_cached_request_for_the_same_due_groups)
+{
+    planner.setPollPeriod("rev", FIELD_GROUP_POSE, Time::fromMilliseconds(50));
+    planner.setPollPeriod("rev", FIELD_GROUP_LEAK, Time::fromMilliseconds(100));
+
+    auto const* both = &planner.tick(start);
+    auto const* pose = &planner.tick(start + Time::fromMilliseconds(50));
+    ASSERT_NE(both, pose);
+    ASSERT_EQ(both, &planner.tick(start + Time::fromMilliseconds(100)));
+    ASSERT_EQ(pose, &planner.tick(start + Time::fromMilliseconds(150)));
+}
@@ -0,0 +1,148 @@
+#include <deep_trekker/SendCoalescer.hpp>
+#include <gtest/gtest.h>
+
+using namespace std;
+using namespace base;
+using namespace deep_trekker;
+
+struct SendCoalescerTest : public ::testing::Test {
+    mutex lock;
+    vector<pair<string, size_t>> frames;
+
+    SendCoalescer::SendFrame recorder()
+    {
+        return [this](string const& frame, size_t count) {
+            lock_guard<mutex> guard(lock);
+            frames.emplace_back(frame, count);
+        };
+    }
+
+    size_t frameCount()
+    {
+        lock_guard<mutex> guard(lock);
+        return frames.size();
+    }
+};
+
+TEST_F(SendCoalescerTest, it_joins_the_records_sent_within_the_window)
+{
+    SendCoalescer coalescer(recorder(), Time::fromSeconds(10));
+    coalescer.send("{\"a\":1}\x1e");
+    coalescer.send("{\"b\":2}\x1e");
+    ASSERT_EQ(2, coalescer.getPendingCount());
+    ASSERT_EQ(0, frameCount());
+
+    coalescer.flush();
+    ASSERT_EQ(1, frameCount());
+    ASSERT_EQ("{\"a\":1}\x1e{\"b\":2}\x1e", frames[0].first);
+    ASSERT_EQ(2, frames[0].second);
+    ASSERT_EQ(0, coalescer.getPendingCount());
+}
+
+TEST_F(SendCoalescerTest, it_sends_the_batch_when_the_window_elapses)
+{
+    SendCoalescer coalescer(recorder(), Time::fromMilliseconds(10));
+    coalescer.send("a\x1e");
+    coalescer.send("b\x1e");
+
+    auto deadline = Time::now() + Time::fromSeconds(2);
+    while (frameCount() == 0 && Time::now() < deadline) {
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+    ASSERT_EQ(1, frameCount());
+    ASSERT_EQ("a\x1e"
+              "b\x1e",
+        frames[0].first);
+}
+
+TEST_F(SendCoalescerTest, it_keeps_the_messages_that_are_not_records_in_their_own_frame)
+{
+    SendCoalescer coalescer(recorder(), Time::fromSeconds(10));
+    coalescer.send("a\x1e");
+    coalescer.send("{\"plain\":true}");
+    ASSERT_EQ(2, frameCount());
+    ASSERT_EQ("a\x1e", frames[0].first);
+    ASSERT_EQ("{\"plain\":true}", frames[1].first);
+}
+
+TEST_F(SendCoalescerTest, it_sends_latency_critical_messages_with_the_pending_batch)
+{
+    SendCoalescer coalescer(recorder(), Time::fromSeconds(10));
+    coalescer.send("a\x1e");
+    coalescer.sendNow("b\x1e");
+    ASSERT_EQ(1, frameCount());
+    ASSERT_EQ("a\x1e"
+              "b\x1e",
+        frames[0].first);
+    ASSERT_EQ(2, frames[0].second);
+}
+
+TEST_F(SendCoalescerTest, it_sends_the_batch_once_it_reaches_the_maximum_size)
+{
+    SendCoalescer coalescer(recorder(), Time::fromSeconds(10), 4);
+    coalescer.send("ab\x1e");
+    ASSERT_EQ(0, frameCount());
+    coalescer.send("c\x1e");
+    ASSERT_EQ(1, frameCount());
+}
+
+TEST_F(SendCoalescerTest, it_sends_the_pending_batch_on_destruction)
+{
+    {
+        SendCoalescer coalescer(recorder(), Time::fromSeconds(10));
+        coalescer.send("a\x1e");
+    }
+    ASSERT_EQ(1, frameCount());
+}
+
+struct FailingSendCoalescerTest : public SendCoalescerTest {
+    SendCoalescer::SendFrame failing()
+    {
+        return [this](string const& frame, size_t count) {
+            {
+                lock_guard<mutex> guard(lock);
+                frames.emplace_back(frame, count);
+            }
+            throw runtime_error("WebSocket is not open");
+        };
+    }
+};
+
+TEST_F(FailingSendCoalescerTest, it_drops_the_batch_when_a_timed_send_fails)
+{
+    SendCoalescer coalescer(failing(), Time::fromMilliseconds(10));
+    coalescer.send("a\x1e");
+
+    auto deadline = Time::now() + Time::fromSeconds(2);
+    while (frameCount() == 0 && Time::now() < deadline) {
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+    ASSERT_EQ(1, frameCount());
+    ASSERT_EQ(0, coalescer.getPendingCount());
+
+    coalescer.send("b\x1e");
+    while (frameCount() == 1 && Time::now() < deadline) {
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+    ASSERT_EQ(2, frameCount());
+    ASSERT_EQ("b\x1e", frames[1].first);
+}
+
+TEST_F(FailingSendCoalescerTest, it_reports_the_send_error_to_the_caller_of_flush)
+{
+    SendCoalescer coalescer(failing(), Time::fromSeconds(10));
+    coalescer.send("a\x1e");
+    ASSERT_THROW(coalescer.flush(), runtime_error);
+    ASSERT_EQ(0, coalescer.getPendingCount());
+    coalescer.flush();
+    ASSERT_EQ(1, frameCount());
+}
+
+TEST_F(FailingSendCoalescerTest, it_survives_a_failed_send_on_destruction)
+{
+    {
+        SendCoalescer coalescer(failing(), Time::fromSeconds(10));
+        coalescer.send("a\x1e");
+    }
+    ASSERT_EQ(1, frameCount());
+}
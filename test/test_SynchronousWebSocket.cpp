@@ -0,0 +1,300 @@
+#include <deep_trekker/SynchronousWebSocket.hpp>
+#include <gtest/gtest.h>
+#include <atomic>
+#include <future>
+#include <sstream>
+#include <thread>
+
+using namespace std;
+using namespace deep_trekker;
+
+static vector<string_view> split(string_view frame)
+{
+    vector<string_view> records;
+    SynchronousWebSocket::splitRecords(frame,
+        [&records](string_view record) { records.push_back(record); });
+    return records;
+}
+
+TEST(SynchronousWebSocketTest, it_splits_the_records_of_a_frame_in_place)
+{
+    string frame = "{\"a\":1}\x1e{\"b\":2}\x1e";
+    auto records = split(frame);
+    ASSERT_EQ(2, records.size());
+    ASSERT_EQ("{\"a\":1}", records[0]);
+    ASSERT_EQ("{\"b\":2}", records[1]);
+    ASSERT_EQ(frame.data(), records[0].data());
+    ASSERT_EQ(frame.data() + 8, records[1].data());
+}
+
+TEST(SynchronousWebSocketTest, it_splits_records_the_same_way_than_getline)
+{
+    string const sep = "\x1e";
+    vector<string> frames{"", "a", "a" + sep, "a" + sep + sep + "b", sep + "a"};
+    for (auto const& frame : frames) {
+        vector<string> expected;
+        stringstream ss(frame);
+        string record;
+        while (getline(ss, record, '\x1e')) {
+            expected.push_back(record);
+        }
+
+        auto records = split(frame);
+        ASSERT_EQ(vector<string>(records.begin(), records.end()), expected)
+            << "frame: " << frame;
+    }
+}
+
+TEST(SynchronousWebSocketTest, it_reconnects_immediately_then_backs_off_exponentially)
+{
+    SynchronousWebSocket::ReconnectPolicy policy;
+    policy.initial_delay = base::Time::fromMilliseconds(100);
+    policy.max_delay = base::Time::fromMilliseconds(1000);
+    policy.multiplier = 2;
+    policy.jitter = 0;
+
+    ASSERT_EQ(base::Time(), policy.delayFor(0, 0));
+    ASSERT_EQ(base::Time::fromMilliseconds(100), policy.delayFor(1, 0));
+    ASSERT_EQ(base::Time::fromMilliseconds(200), policy.delayFor(2, 0));
+    ASSERT_EQ(base::Time::fromMilliseconds(800), policy.delayFor(4, 0));
+    ASSERT_EQ(base::Time::fromMilliseconds(1000), policy.delayFor(5, 0));
+    ASSERT_EQ(base::Time::fromMilliseconds(1000), policy.delayFor(100, 0));
+}
+
+TEST(SynchronousWebSocketTest, it_applies_the_jitter_around_the_backoff_delay)
+{
+    SynchronousWebSocket::ReconnectPolicy policy;
+    policy.initial_delay = base::Time::fromMilliseconds(100);
+    policy.jitter = 0.2;
+
+    ASSERT_EQ(base::Time::fromMilliseconds(80), policy.delayFor(1, -1));
+    ASSERT_EQ(base::Time::fromMilliseconds(120), policy.delayFor(1, 1));
+    ASSERT_EQ(base::Time(), policy.delayFor(0, 1));
+}
+
+TEST(SynchronousWebSocketTest, it_drops_the_messages_sent_while_reconnecting)
+{
+    SynchronousWebSocket ws("test");
+    ws.enableAutoReconnect();
+    ASSERT_TRUE(ws.hasAutoReconnect());
+    ASSERT_FALSE(ws.isConnected());
+    ws.send(string("msg"));
+    ASSERT_EQ(0, ws.getMetrics().sent_frames);
+
+    ws.disableAutoReconnect();
+    ASSERT_FALSE(ws.hasAutoReconnect());
+}
+
+TEST(SynchronousWebSocketTest, it_reconnects_after_the_server_drops_the_connection)
+{
+    rtc::WebSocketServer::Configuration config;
+    config.port = 0;
+    rtc::WebSocketServer server(config);
+    mutex clients_lock;
+    vector<shared_ptr<rtc::WebSocket>> clients;
+    server.onClient([&](shared_ptr<rtc::WebSocket> client) {
+        lock_guard<mutex> lock(clients_lock);
+        clients.push_back(client);
+    });
+
+    SynchronousWebSocket ws("test");
+    atomic<int> connected_count{0};
+    promise<void> disconnected;
+    promise<void> reconnected;
+    ws.onConnected([&] {
+        if (++connected_count == 2) {
+            reconnected.set_value();
+        }
+    });
+    ws.onDisconnected([&] { disconnected.set_value(); });
+    SynchronousWebSocket::ReconnectPolicy policy;
+    policy.initial_delay = base::Time::fromMilliseconds(10);
+    ws.enableAutoReconnect(policy);
+    ws.open("ws://127.0.0.1:" + to_string(server.port()), base::Time::fromSeconds(1));
+    ASSERT_EQ(1, connected_count);
+
+    {
+        lock_guard<mutex> lock(clients_lock);
+        ASSERT_EQ(1, clients.size());
+        clients.front()->close();
+    }
+    ASSERT_EQ(future_status::ready,
+        disconnected.get_future().wait_for(chrono::seconds(1)));
+    ASSERT_EQ(future_status::ready,
+        reconnected.get_future().wait_for(chrono::seconds(1)));
+    ASSERT_TRUE(ws.isConnected());
+    ASSERT_EQ(1, ws.getMetrics().disconnect_count);
+
+    ws.close(base::Time::fromSeconds(1));
+    server.stop();
+}
+
+TEST(SynchronousWebSocketTest, it_fails_to_open_a_closed_port_within_the_timeout)
+{
+    SynchronousWebSocket ws("test");
+    auto start = base::Time::now();
+    // Depending on the network stack, the connection is either refused or
+    // times out
+    ASSERT_THROW(ws.open("ws://127.0.0.1:1", base::Time::fromMilliseconds(200)),
+        runtime_error);
+    ASSERT_LT(base::Time::now() - start, base::Time::fromSeconds(1));
+    ASSERT_FALSE(ws.isConnected());
+}
+
+TEST(SynchronousWebSocketTest, it_opens_all_websockets_within_a_single_timeout)
+{
+    SynchronousWebSocket ws1("test1");
+    SynchronousWebSocket ws2("test2");
+    auto start = base::Time::now();
+    ASSERT_THROW(SynchronousWebSocket::openAll(
+                     {{&ws1, "ws://127.0.0.1:1"}, {&ws2, "ws://127.0.0.1:2"}},
+                     base::Time::fromMilliseconds(300)),
+        runtime_error);
+    // Opening sequentially would take up to twice the timeout
+    ASSERT_LT(base::Time::now() - start, base::Time::fromMilliseconds(550));
+    ASSERT_FALSE(ws1.isConnected());
+    ASSERT_FALSE(ws2.isConnected());
+}
+
+TEST(SynchronousWebSocketTest, it_closes_all_websockets_within_a_single_timeout)
+{
+    SynchronousWebSocket ws1("test1");
+    SynchronousWebSocket ws2("test2");
+    auto start = base::Time::now();
+    // Closing sockets that never opened either completes immediately or times
+    // out, depending on the websocket implementation
+    try {
+        SynchronousWebSocket::closeAll({&ws1, &ws2}, base::Time::fromMilliseconds(300));
+    }
+    catch (runtime_error&) {
+    }
+    ASSERT_LT(base::Time::now() - start, base::Time::fromMilliseconds(550));
+    ASSERT_FALSE(ws1.isConnected());
+    ASSERT_FALSE(ws2.isConnected());
+}
+
+/** Records the messages dispatched by a websocket, holding the dispatch thread
+ * in the callback of the "block" message until release() is called
+ */
+struct DispatchRecorder {
+    mutex lock;
+    vector<string> messages;
+    promise<void> entered;
+    promise<void> gate;
+    shared_future<void> gate_future = gate.get_future().share();
+
+    SynchronousWebSocket::OnTimestampedMessage callback()
+    {
+        return [this](string_view msg, base::Time const&) {
+            {
+                lock_guard<mutex> guard(lock);
+                messages.emplace_back(msg);
+            }
+            if (msg == "block") {
+                entered.set_value();
+                gate_future.wait();
+            }
+        };
+    }
+
+    /** Send the "block" message, and wait for the dispatch thread to hold it */
+    void block(SynchronousWebSocket& ws)
+    {
+        auto future = entered.get_future();
+        ws.receiveFrame("block", base::Time::now());
+        future.wait();
+    }
+
+    void release()
+    {
+        gate.set_value();
+    }
+};
+
+TEST(SynchronousWebSocketTest, it_dispatches_in_the_calling_thread_by_default)
+{
+    SynchronousWebSocket ws("test");
+    vector<string> messages;
+    ws.onMessage([&](string_view msg, base::Time const&) { messages.emplace_back(msg); });
+    ws.receiveFrame("a\x1e"
+                    "b\x1e",
+        base::Time::now());
+    ASSERT_EQ((vector<string>{"a", "b"}), messages);
+    ASSERT_FALSE(ws.hasDispatchThread());
+}
+
+TEST(SynchronousWebSocketTest, it_drops_the_newest_frames_when_the_queue_is_full)
+{
+    SynchronousWebSocket ws("test");
+    DispatchRecorder recorder;
+    ws.onMessage(recorder.callback());
+    ws.startDispatchThread(2, SynchronousWebSocket::OVERFLOW_DROP_NEWEST);
+
+    recorder.block(ws);
+    for (string frame : {"1", "2", "3", "4"}) {
+        ws.receiveFrame(frame, base::Time::now());
+    }
+    auto stats = ws.getDispatchQueueStats();
+    ASSERT_EQ(2, stats.capacity);
+    ASSERT_EQ(2, stats.depth);
+
+    recorder.release();
+    ws.stopDispatchThread();
+    ASSERT_FALSE(ws.hasDispatchThread());
+    ASSERT_EQ((vector<string>{"block", "1", "2"}), recorder.messages);
+    stats = ws.getDispatchQueueStats();
+    ASSERT_EQ(3, stats.queued);
+    ASSERT_EQ(2, stats.dropped);
+    ASSERT_EQ(3, stats.dispatched);
+    ASSERT_EQ(2, stats.max_depth);
+}
+
+TEST(SynchronousWebSocketTest, it_drops_the_oldest_frames_when_the_queue_is_full)
+{
+    SynchronousWebSocket ws("test");
+    DispatchRecorder recorder;
+    ws.onMessage(recorder.callback());
+    ws.startDispatchThread(2, SynchronousWebSocket::OVERFLOW_DROP_OLDEST);
+
+    recorder.block(ws);
+    for (string frame : {"1", "2", "3", "4"}) {
+        ws.receiveFrame(frame, base::Time::now());
+    }
+
+    recorder.release();
+    ws.stopDispatchThread();
+    ASSERT_EQ((vector<string>{"block", "3", "4"}), recorder.messages);
+    auto stats = ws.getDispatchQueueStats();
+    ASSERT_EQ(5, stats.queued);
+    ASSERT_EQ(2, stats.dropped);
+    ASSERT_EQ(3, stats.dispatched);
+}
+
+TEST(SynchronousWebSocketTest, it_blocks_the_receiving_thread_when_the_queue_is_full)
+{
+    SynchronousWebSocket ws("test");
+    DispatchRecorder recorder;
+    ws.onMessage(recorder.callback());
+    ws.startDispatchThread(2, SynchronousWebSocket::OVERFLOW_BLOCK);
+
+    recorder.block(ws);
+    ws.receiveFrame("1", base::Time::now());
+    ws.receiveFrame("2", base::Time::now());
+
+    atomic<bool> received{false};
+    thread network([&] {
+        ws.receiveFrame("3", base::Time::now());
+        received = true;
+    });
+    this_thread::sleep_for(chrono::milliseconds(50));
+    ASSERT_FALSE(received);
+
+    recorder.release();
+    network.join();
+    ws.stopDispatchThread();
+    ASSERT_EQ((vector<string>{"block", "1", "2", "3"}), recorder.messages);
+    auto stats = ws.getDispatchQueueStats();
+    ASSERT_EQ(4, stats.queued);
+    ASSERT_EQ(0, stats.dropped);
+    ASSERT_EQ(4, stats.dispatched);
+}
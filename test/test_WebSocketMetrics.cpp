@@ -0,0 +1,88 @@
+#include <deep_trekker/WebSocketMetrics.hpp>
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace std;
+using namespace base;
+using namespace deep_trekker;
+
+TEST(Log2HistogramTest, it_bins_values_by_power_of_two)
+{
+    ASSERT_EQ(0, Log2Histogram::binOf(0));
+    ASSERT_EQ(1, Log2Histogram::binOf(1));
+    ASSERT_EQ(2, Log2Histogram::binOf(2));
+    ASSERT_EQ(2, Log2Histogram::binOf(3));
+    ASSERT_EQ(3, Log2Histogram::binOf(4));
+    ASSERT_EQ(Log2Histogram::BIN_COUNT - 1, Log2Histogram::binOf(~uint64_t(0)));
+}
+
+TEST(Log2HistogramTest, it_computes_the_statistics)
+{
+    Log2Histogram histogram;
+    for (uint64_t value : {1, 2, 3, 100}) {
+        histogram.add(value);
+    }
+    ASSERT_EQ(4, histogram.count);
+    ASSERT_EQ(106, histogram.sum);
+    ASSERT_EQ(100, histogram.max);
+    ASSERT_DOUBLE_EQ(26.5, histogram.mean());
+    ASSERT_EQ(1, histogram.quantileUpperBound(0));
+    ASSERT_EQ(3, histogram.quantileUpperBound(0.5));
+    ASSERT_EQ(100, histogram.quantileUpperBound(1));
+    ASSERT_EQ(0, Log2Histogram().quantileUpperBound(0.5));
+}
+
+TEST(WebSocketMetricsTest, it_accumulates_the_traffic)
+{
+    WebSocketMetrics metrics;
+    metrics.recordSent(10, 1, 0);
+    metrics.recordSent(20, 3, 100);
+    metrics.recordSent(5, 1, 50);
+    metrics.recordFrame(300, 2);
+    metrics.recordFrame(100, 1);
+    metrics.recordParse(12, true);
+    metrics.recordParse(3, false);
+    metrics.recordCallbacks(40);
+    metrics.recordOpen(Time::fromMilliseconds(150));
+
+    auto snapshot = metrics.snapshot();
+    ASSERT_EQ(3, snapshot.sent_frames);
+    ASSERT_EQ(5, snapshot.sent_messages);
+    ASSERT_EQ(35, snapshot.sent_bytes);
+    ASSERT_EQ(100, snapshot.max_send_buffered_bytes);
+    ASSERT_EQ(2, snapshot.received_frames);
+    ASSERT_EQ(3, snapshot.received_messages);
+    ASSERT_EQ(400, snapshot.received_bytes);
+    ASSERT_EQ(2, snapshot.records_per_frame.max);
+    ASSERT_EQ(2, snapshot.parse_time_us.count);
+    ASSERT_EQ(1, snapshot.json_errors);
+    ASSERT_EQ(40, snapshot.callback_time_us.sum);
+    ASSERT_EQ(1, snapshot.open_count);
+    ASSERT_EQ(Time::fromMilliseconds(150), snapshot.last_open_duration);
+    ASSERT_EQ(0, snapshot.close_count);
+    ASSERT_EQ(0, snapshot.disconnect_count);
+    ASSERT_NE(string::npos, snapshot.toString().find("received 2 frames/3 msgs/400 B"));
+
+    metrics.reset();
+    snapshot = metrics.snapshot();
+    ASSERT_EQ(0, snapshot.sent_messages);
+    ASSERT_EQ(0, snapshot.records_per_frame.count);
+}
+
+TEST(WebSocketMetricsTest, it_can_be_updated_from_several_threads)
+{
+    WebSocketMetrics metrics;
+    auto update = [&metrics] {
+        for (int i = 0; i < 10000; ++i) {
+            metrics.recordFrame(10, 1);
+        }
+    };
+    thread other(update);
+    update();
+    other.join();
+
+    auto snapshot = metrics.snapshot();
+    ASSERT_EQ(20000, snapshot.received_frames);
+    ASSERT_EQ(200000, snapshot.received_bytes);
+    ASSERT_EQ(20000, snapshot.records_per_frame.bins[1]);
+}
@@ -0,0 +1,123 @@
+#include <deep_trekker/ZoomCameraCommandBatcher.hpp>
+#include <gtest/gtest.h>
+#include <json/json.h>
+
+using namespace std;
+using namespace base;
+using namespace deep_trekker;
+
+struct ZoomCameraCommandBatcherTest : public ::testing::Test {
+    ZoomCameraCommandBatcher batcher{"12.0.2",
+        "1.2.3.4.5.6",
+        13,
+        "zoom0",
+        Time::fromMilliseconds(200)};
+    Time start = Time::now();
+
+    TamronHarrierZoomCameraCommand command()
+    {
+        TamronHarrierZoomCameraCommand command;
+        command.exposure = 0.5;
+        command.brightness = 0.4;
+        command.focus = 0.3;
+        command.saturation = 0.2;
+        command.sharpness = 0.1;
+        command.zoom.ratio = 2;
+        command.zoom.speed = 0;
+        return command;
+    }
+
+    Json::Value camera(string const& message)
+    {
+        Json::Value json;
+        Json::CharReaderBuilder builder;
+        unique_ptr<Json::CharReader> reader(builder.newCharReader());
+        string errors;
+        EXPECT_TRUE(reader->parse(message.data(),
+            message.data() + message.size(),
+            &json,
+            &errors));
+        return json["payload"]["devices"]["1.2.3.4.5.6"]["cameras"]["zoom0"];
+    }
+};
+
+TEST_F(ZoomCameraCommandBatcherTest, it_sends_all_the_settings_first)
+{
+    auto cam = camera(batcher.update(command(), start));
+    ASSERT_EQ(ZOOM_CAMERA_ALL_SETTINGS, batcher.getLastSentSettings());
+    ASSERT_EQ(50, cam["exposure"].asDouble());
+    ASSERT_EQ(40, cam["brightness"].asDouble());
+    ASSERT_EQ(30, cam["focus"].asDouble());
+    ASSERT_EQ(20, cam["saturation"].asDouble());
+    ASSERT_EQ(10, cam["sharpness"].asDouble());
+    ASSERT_EQ(2, cam["zoom"]["ratio"].asDouble());
+    ASSERT_EQ(0, cam["zoom"]["speed"].asDouble());
+}
+
+TEST_F(ZoomCameraCommandBatcherTest, it_packs_only_the_changed_settings)
+{
+    batcher.update(command(), start);
+    ASSERT_TRUE(batcher.update(command(), start).empty());
+
+    auto cmd = command();
+    cmd.focus = 0.8;
+    cmd.sharpness = 0.9;
+    cmd.exposure = 0.501; // same once encoded
+    auto cam = camera(batcher.update(cmd, start));
+    ASSERT_EQ(ZOOM_CAMERA_FOCUS | ZOOM_CAMERA_SHARPNESS, batcher.getLastSentSettings());
+    ASSERT_EQ(vector<string>({"focus", "sharpness"}), cam.getMemberNames());
+    ASSERT_EQ(80, cam["focus"].asDouble());
+    ASSERT_EQ(90, cam["sharpness"].asDouble());
+}
+
+TEST_F(ZoomCameraCommandBatcherTest, it_rate_limits_the_zoom_speed)
+{
+    auto cmd = command();
+    cmd.zoom.speed = 0.5;
+    batcher.update(cmd, start);
+
+    cmd.zoom.speed = 0.6;
+    ASSERT_TRUE(batcher.update(cmd, start + Time::fromMilliseconds(50)).empty());
+    cmd.zoom.speed = 0.7;
+    ASSERT_TRUE(batcher.update(cmd, start + Time::fromMilliseconds(100)).empty());
+    ASSERT_TRUE(batcher.hasPendingZoomSpeed());
+
+    auto cam = camera(batcher.poll(start + Time::fromMilliseconds(200)));
+    ASSERT_EQ(70, cam["zoom"]["speed"].asDouble());
+    ASSERT_FALSE(batcher.hasPendingZoomSpeed());
+    ASSERT_TRUE(batcher.poll(start + Time::fromMilliseconds(400)).empty());
+}
+
+TEST_F(ZoomCameraCommandBatcherTest, it_sends_the_other_settings_while_holding_the_speed)
+{
+    auto cmd = command();
+    cmd.zoom.speed = 0.5;
+    batcher.update(cmd, start);
+
+    cmd.zoom.speed = 0.6;
+    cmd.brightness = 1;
+    auto cam = camera(batcher.update(cmd, start + Time::fromMilliseconds(50)));
+    ASSERT_EQ(ZOOM_CAMERA_BRIGHTNESS, batcher.getLastSentSettings());
+    ASSERT_FALSE(cam.isMember("zoom"));
+    ASSERT_TRUE(batcher.hasPendingZoomSpeed());
+}
+
+TEST_F(ZoomCameraCommandBatcherTest, it_never_holds_back_stopping_the_zoom)
+{
+    auto cmd = command();
+    cmd.zoom.speed = -1;
+    batcher.update(cmd, start);
+
+    cmd.zoom.speed = 0;
+    auto cam = camera(batcher.update(cmd, start + Time::fromMilliseconds(10)));
+    ASSERT_EQ(ZOOM_CAMERA_ZOOM_SPEED, batcher.getLastSentSettings());
+    ASSERT_EQ(0, cam["zoom"]["speed"].asDouble());
+}
+
+TEST_F(ZoomCameraCommandBatcherTest, it_sends_all_the_settings_again_after_a_reset)
+{
+    batcher.update(command(), start);
+    batcher.reset();
+    batcher.update(command(), start);
+    ASSERT_EQ(ZOOM_CAMERA_ALL_SETTINGS, batcher.getLastSentSettings());
+}